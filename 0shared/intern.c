@@ -0,0 +1,217 @@
+/*--------------------------------------------------------------------*/
+/* intern.c                                                           */
+/* Author: Zara Hommez                                                */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "intern.h"
+
+/* The number of buckets the table starts with once first used */
+enum { INITIAL_BUCKET_COUNT = 64 };
+
+/* One interned string. Its bytes, plus a trailing '\0', are stored in
+   the same allocation immediately after the struct, which is how an
+   interned pointer leads back to its entry. */
+struct entry {
+   /* the next entry in the same bucket */
+   struct entry *psNext;
+   /* the hash of the string's bytes */
+   unsigned long long ullHash;
+   /* the string length of the interned string */
+   size_t ulLength;
+   /* the number of references callers currently hold */
+   size_t ulRefCount;
+};
+
+/* the buckets of the table, each a chain of entries */
+static struct entry **ppsBuckets;
+/* the number of buckets in ppsBuckets */
+static size_t ulBucketCount;
+/* usage counters, as reported by Intern_getStats */
+static struct Intern_Stats sStats;
+
+unsigned long long Intern_hash(const char *pcStr, size_t ulLength) {
+   unsigned long long ullHash = 14695981039346656037ULL;
+   size_t i;
+
+   assert(pcStr != NULL);
+
+   /* 64-bit FNV-1a */
+   for(i = 0; i < ulLength; i++) {
+      ullHash ^= (unsigned char) pcStr[i];
+      ullHash *= 1099511628211ULL;
+   }
+   return ullHash;
+}
+
+/* Returns the entry holding interned string pcInterned. */
+static struct entry *Intern_entryOf(const char *pcInterned) {
+   assert(pcInterned != NULL);
+
+   return (struct entry *) (void *) pcInterned - 1;
+}
+
+/* Returns the string stored in psEntry. */
+static const char *Intern_textOf(struct entry *psEntry) {
+   assert(psEntry != NULL);
+
+   return (const char *) (psEntry + 1);
+}
+
+/* Rehashes every entry into a bucket array of ulNewCount buckets.
+   Leaves the table as it was if memory could not be allocated, which
+   only makes chains longer. */
+static void Intern_rehash(size_t ulNewCount) {
+   struct entry **ppsNew;
+   size_t i;
+
+   ppsNew = calloc(ulNewCount, sizeof(struct entry *));
+   if(ppsNew == NULL)
+      return;
+
+   for(i = 0; i < ulBucketCount; i++) {
+      struct entry *psEntry = ppsBuckets[i];
+      while(psEntry != NULL) {
+         struct entry *psNext = psEntry->psNext;
+         size_t ulBucket = (size_t) (psEntry->ullHash % ulNewCount);
+         psEntry->psNext = ppsNew[ulBucket];
+         ppsNew[ulBucket] = psEntry;
+         psEntry = psNext;
+      }
+   }
+
+   free(ppsBuckets);
+   ppsBuckets = ppsNew;
+   ulBucketCount = ulNewCount;
+}
+
+const char *Intern_string(const char *pcStr, size_t ulLength) {
+   assert(pcStr != NULL);
+
+   return Intern_stringHashed(pcStr, ulLength,
+                              Intern_hash(pcStr, ulLength));
+}
+
+const char *Intern_stringHashed(const char *pcStr, size_t ulLength,
+                                unsigned long long ullHash) {
+   size_t ulBucket;
+   struct entry *psEntry;
+   char *pcText;
+
+   assert(pcStr != NULL);
+   assert(ullHash == Intern_hash(pcStr, ulLength));
+
+   sStats.ulLookups++;
+
+   if(ulBucketCount != 0) {
+      ulBucket = (size_t) (ullHash % ulBucketCount);
+      for(psEntry = ppsBuckets[ulBucket]; psEntry != NULL;
+          psEntry = psEntry->psNext) {
+         if(psEntry->ullHash == ullHash && psEntry->ulLength == ulLength &&
+            memcmp(Intern_textOf(psEntry), pcStr, ulLength) == 0) {
+            sStats.ulHits++;
+            return Intern_retain(Intern_textOf(psEntry));
+         }
+      }
+   }
+
+   /* keep the load factor at most 1 */
+   if(sStats.ulEntries >= ulBucketCount) {
+      if(ulBucketCount == 0)
+         Intern_rehash(INITIAL_BUCKET_COUNT);
+      else
+         Intern_rehash(2 * ulBucketCount);
+      if(ulBucketCount == 0)
+         return NULL;
+   }
+
+   psEntry = malloc(sizeof(struct entry) + ulLength + 1);
+   if(psEntry == NULL)
+      return NULL;
+   pcText = (char *) (psEntry + 1);
+   memcpy(pcText, pcStr, ulLength);
+   pcText[ulLength] = '\0';
+   psEntry->ullHash = ullHash;
+   psEntry->ulLength = ulLength;
+   psEntry->ulRefCount = 1;
+
+   ulBucket = (size_t) (ullHash % ulBucketCount);
+   psEntry->psNext = ppsBuckets[ulBucket];
+   ppsBuckets[ulBucket] = psEntry;
+
+   sStats.ulEntries++;
+   sStats.ulReferences++;
+   sStats.ulBytesStored += ulLength + 1;
+   return pcText;
+}
+
+const char *Intern_retain(const char *pcInterned) {
+   struct entry *psEntry;
+
+   assert(pcInterned != NULL);
+
+   psEntry = Intern_entryOf(pcInterned);
+   assert(psEntry->ulRefCount > 0);
+   psEntry->ulRefCount++;
+
+   sStats.ulReferences++;
+   sStats.ulBytesSaved += psEntry->ulLength + 1;
+   return pcInterned;
+}
+
+void Intern_release(const char *pcInterned) {
+   struct entry *psEntry;
+   struct entry **ppsLink;
+
+   if(pcInterned == NULL)
+      return;
+
+   psEntry = Intern_entryOf(pcInterned);
+   assert(psEntry->ulRefCount > 0);
+   psEntry->ulRefCount--;
+   sStats.ulReferences--;
+
+   if(psEntry->ulRefCount != 0) {
+      sStats.ulBytesSaved -= psEntry->ulLength + 1;
+      return;
+   }
+
+   /* last reference: unlink the entry from its chain and free it */
+   ppsLink = &ppsBuckets[psEntry->ullHash % ulBucketCount];
+   while(*ppsLink != psEntry)
+      ppsLink = &(*ppsLink)->psNext;
+   *ppsLink = psEntry->psNext;
+
+   sStats.ulEntries--;
+   sStats.ulBytesStored -= psEntry->ulLength + 1;
+   free(psEntry);
+}
+
+size_t Intern_getLength(const char *pcInterned) {
+   assert(pcInterned != NULL);
+
+   return Intern_entryOf(pcInterned)->ulLength;
+}
+
+unsigned long long Intern_getHash(const char *pcInterned) {
+   assert(pcInterned != NULL);
+
+   return Intern_entryOf(pcInterned)->ullHash;
+}
+
+void Intern_getStats(struct Intern_Stats *psStats) {
+   assert(psStats != NULL);
+
+   *psStats = sStats;
+}
+
+void Intern_trim(void) {
+   if(sStats.ulEntries != 0)
+      return;
+   free(ppsBuckets);
+   ppsBuckets = NULL;
+   ulBucketCount = 0;
+}
@@ -0,0 +1,92 @@
+/*--------------------------------------------------------------------*/
+/* intern.h                                                           */
+/* Author: Zara Hommez                                                */
+/*--------------------------------------------------------------------*/
+
+#ifndef INTERN_INCLUDED
+#define INTERN_INCLUDED
+
+/*
+  The intern table keeps one canonical, immutable, '\0'-terminated
+  copy of each distinct string handed to it, so that repeated path
+  components ("src", "lib", ...) are stored once however many paths
+  and nodes use them. Two interned strings are equal exactly when
+  they are the same pointer. Each canonical copy is reference counted
+  and freed when its last reference is released.
+*/
+
+#include <stddef.h>
+
+/* Counters describing how the intern table has been used */
+struct Intern_Stats {
+   /* the number of Intern_string calls */
+   size_t ulLookups;
+   /* the number of those calls that found the string already interned */
+   size_t ulHits;
+   /* the number of distinct strings currently interned */
+   size_t ulEntries;
+   /* the number of references currently held across all entries */
+   size_t ulReferences;
+   /* the bytes of string data (with '\0's) currently held */
+   size_t ulBytesStored;
+   /* the further bytes that every current reference holding its own
+      private copy would have needed */
+   size_t ulBytesSaved;
+};
+
+/*
+  Returns the canonical copy of the ulLength bytes at pcStr (which
+  need not be '\0'-terminated and must not contain '\0'), interning
+  them first if needed, and takes one reference to it on behalf of the
+  caller. Returns NULL if memory could not be allocated.
+*/
+const char *Intern_string(const char *pcStr, size_t ulLength);
+
+/*
+  Does the same as Intern_string, for a caller that has already
+  computed ullHash as Intern_hash(pcStr, ulLength), possibly on another
+  thread. Unlike Intern_hash, neither function is safe to call from
+  more than one thread at a time.
+*/
+const char *Intern_stringHashed(const char *pcStr, size_t ulLength,
+                                unsigned long long ullHash);
+
+/*
+  Takes one more reference to pcInterned, which must have been
+  returned by Intern_string and not yet fully released. Returns
+  pcInterned.
+*/
+const char *Intern_retain(const char *pcInterned);
+
+/*
+  Drops one reference to pcInterned, freeing the canonical copy when
+  no references remain. pcInterned may be NULL, as this is a no-op.
+*/
+void Intern_release(const char *pcInterned);
+
+/*
+  Returns the 64-bit hash of the ulLength bytes at pcStr, the same
+  hash Intern_string computes when interning them.
+*/
+unsigned long long Intern_hash(const char *pcStr, size_t ulLength);
+
+/* Returns the string length of interned string pcInterned. */
+size_t Intern_getLength(const char *pcInterned);
+
+/*
+  Returns the hash of interned string pcInterned, as cached when it
+  was interned, without reading its bytes.
+*/
+unsigned long long Intern_getHash(const char *pcInterned);
+
+/* Fills *psStats with the intern table's current counters. */
+void Intern_getStats(struct Intern_Stats *psStats);
+
+/*
+  Frees the table's buckets if no string is interned, so that a table
+  that grew large and emptied again holds no memory. The next
+  Intern_string starts a new, small table.
+*/
+void Intern_trim(void);
+
+#endif
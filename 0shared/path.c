@@ -4,161 +4,619 @@
 /*--------------------------------------------------------------------*/
 
 #include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
-#include "dynarray.h"
+#include "intern.h"
 #include "path.h"
 
-/* An absolute path */
+/* An absolute path. Paths are immutable once built, so one struct may
+   be shared by every holder of a Path_dup, and a prefix may share the
+   component table of the path it was taken from.
+   Each path is a single allocation: this header, then (unless it is
+   a prefix) its tables of prefix hashes and of component pointers,
+   then its pathname. Short paths use a fixed-size inline block,
+   which is recycled rather than freed; others spill to a block sized
+   exactly for them. */
 struct path {
+   /* The number of holders of this path; it is freed when the last
+      holder calls Path_free. It is not atomic, as path.h warns. */
+   size_t ulRefCount;
    /* The string representation of the path,
       which uses '/' as the component delimiter */
    const char *pcPath;
    /* The string length of pcPath */
    size_t ulLength;
-   /* The ordered collection of component strings in the path */
-   DynArray_T oDComponents;
+   /* The number of components in the path */
+   size_t ulDepth;
+   /* The ordered table of component strings in the path, each an
+      interned string; it lives in oPBase's block if oPBase is set */
+   const char **ppcComponents;
+   /* The table of prefix hashes: entry i is the hash of the first
+      i + 1 components, as built by Path_extendHash; it lives in
+      oPBase's block if oPBase is set */
+   unsigned long long *pullHashes;
+   /* The path owning the table whose first ulDepth components are
+      this path's, or NULL if this path owns its own table (and holds
+      a reference to each interned component in it) */
+   Path_T oPBase;
+   /* Whether this path lives in an inline block */
+   boolean bInline;
 };
 
+/* The most components and the longest pathname (without '\0') a path
+   may have and still be stored inline. A prefix, which keeps no
+   tables of its own, is inline whenever its pathname fits. */
+enum { INLINE_DEPTH = 6, INLINE_LENGTH = 48 };
+
+/* The offset of the hash table within a block: the first suitably
+   aligned one after the header */
+enum { HASH_OFFSET = (sizeof(struct path) + sizeof(unsigned long long)
+                      - 1) / sizeof(unsigned long long) *
+       sizeof(unsigned long long) };
+
+/* The size of an inline block */
+enum { INLINE_SIZE = HASH_OFFSET + INLINE_DEPTH *
+       (sizeof(unsigned long long) + sizeof(const char *)) +
+       INLINE_LENGTH + 1 };
+
+/* The most free inline blocks kept for reuse */
+enum { FREE_BLOCK_LIMIT = 256 };
+
+/* Free inline blocks, chained through their oPBase fields. Neither
+   these nor sStats is locked: path.h keeps the functions that use
+   them to one thread at a time. */
+static struct path *psFreeBlocks;
+/* The number of blocks in psFreeBlocks */
+static size_t ulFreeBlockCount;
+/* Usage counters, as reported by Path_getStats */
+static struct Path_Stats sStats;
+
 /*
-  Frees pcStr. This wrapper is used to match the requirements of the
-  callback function pointer passed to DynArray_map. pvExtra is unused.
+  Returns a new block for a path, inline if bInline and otherwise of
+  ulSize bytes, with its bInline field set; or NULL if memory could not
+  be allocated. Inline blocks are taken from the free list when it has
+  one, with no call to malloc.
 */
-static void Path_freeString(char *pcStr, void *pvExtra) {
-   /* pcStr may be NULL, as this is a no-op to free.
-      pvExtra may be NULL, as it is unused. */
-   free(pcStr);
+static struct path *Path_allocBlock(boolean bInline, size_t ulSize) {
+   struct path *psBlock;
+
+   if(!bInline) {
+      psBlock = malloc(ulSize);
+      if(psBlock == NULL)
+         return NULL;
+      sStats.ulSpilled++;
+   }
+   else if(psFreeBlocks != NULL) {
+      psBlock = psFreeBlocks;
+      psFreeBlocks = (struct path *) psBlock->oPBase;
+      ulFreeBlockCount--;
+      sStats.ulInline++;
+      sStats.ulRecycled++;
+   }
+   else {
+      psBlock = malloc(INLINE_SIZE);
+      if(psBlock == NULL)
+         return NULL;
+      sStats.ulInline++;
+   }
+
+   psBlock->bInline = bInline;
+   return psBlock;
+}
+
+/* Frees psBlock, or keeps it for reuse if it is an inline block and
+   the free list has room. */
+static void Path_freeBlock(struct path *psBlock) {
+   assert(psBlock != NULL);
+
+   if(psBlock->bInline && ulFreeBlockCount < FREE_BLOCK_LIMIT) {
+      psBlock->oPBase = psFreeBlocks;
+      psFreeBlocks = psBlock;
+      ulFreeBlockCount++;
+   }
+   else
+      free(psBlock);
 }
 
 /*
-  Sets *poDComponents to be an ordered collection of component strings
-  in pcPath, or NULL if an error occurs.
-  Returns one of the following statuses:
-  * SUCCESS if no error occurrs
+  Path_validate checks that the ulLength bytes at pcPath are a
+  well-formatted path and, if so, sets *pulDepth to its number of
+  components. It returns one of the following statuses:
+  * SUCCESS if pcPath is well formatted
   * BAD_PATH if pcPath is the empty string,
              or begins or ends with a '/',
              or contains consecutive '/' delimiters
-  * MEMORY_ERROR if memory could not be allocated to complete request
+
+  Two versions follow. The default examines a machine word (8 bytes
+  on 64-bit targets) of the path per step using bit masks; defining
+  PATH_SCALAR_SCAN selects the byte-at-a-time version instead, which
+  the word version is benchmarked against.
 */
-static int Path_split(const char *pcPath, DynArray_T *poDComponents) {
-   const char *pcStart = pcPath;
-   const char *pcEnd = pcPath;
-   char *pcCopy;
-   DynArray_T oDSubstrings;
+
+#ifndef PATH_SCALAR_SCAN
+
+/* A word with every byte set to 0x01 */
+#define PATH_ONES ((size_t) -1 / 0xFF)
+/* A word with every byte set to 0x7F */
+#define PATH_LOWS (PATH_ONES * 0x7F)
+
+/*
+  Returns a mask of the bytes of ulWord equal to '/': the high bit of
+  each such byte is set and every other bit is clear.
+*/
+static size_t Path_slashMask(size_t ulWord) {
+   size_t ulBits = ulWord ^ (PATH_ONES * '/');
+
+   /* a byte of ulBits is zero exactly where ulWord held '/'; the sum
+      sets a byte's high bit iff its low seven bits are non-zero */
+   return ~(((ulBits & PATH_LOWS) + PATH_LOWS) | ulBits | PATH_LOWS);
+}
+
+static int Path_validate(const char *pcPath, size_t ulLength,
+                         size_t *pulDepth) {
+   size_t ulIndex;
+   size_t ulSlashes = 0;
 
    assert(pcPath != NULL);
-   assert(poDComponents != NULL);
+   assert(pulDepth != NULL);
 
-   /* path cannot be empty string */
-   if(*pcPath == '\0') {
-      *poDComponents = NULL;
+   /* path cannot be empty string, nor start or end with a delimiter */
+   if(ulLength == 0 || pcPath[0] == '/' || pcPath[ulLength - 1] == '/')
       return BAD_PATH;
-   }
 
-   oDSubstrings = DynArray_new(0);
-   if(oDSubstrings == NULL) {
-      *poDComponents = NULL;
-      return MEMORY_ERROR;
+   /* whole words: flag every '/' at once, then look for two flagged
+      neighbours within the word or across the previous word's end */
+   for(ulIndex = 0; ulIndex + sizeof(size_t) <= ulLength;
+       ulIndex += sizeof(size_t)) {
+      size_t ulWord, ulMask;
+
+      memcpy(&ulWord, pcPath + ulIndex, sizeof(size_t));
+      ulMask = Path_slashMask(ulWord);
+      if(ulMask == 0)
+         continue;
+      if((ulMask & (ulMask << 8)) != 0 ||
+         (ulIndex > 0 && pcPath[ulIndex - 1] == '/' &&
+          pcPath[ulIndex] == '/'))
+         return BAD_PATH;
+      /* add up the flags, one per byte, in the top byte */
+      ulSlashes += ((ulMask >> 7) * PATH_ONES) >>
+         (8 * (sizeof(size_t) - 1));
    }
 
-   /* validate and split pcPath */
-   while(*pcEnd != '\0') {
-      pcEnd = pcStart;
-      /* component can't start with delimiter */
-      if(*pcEnd == '/') {
-         DynArray_map(oDSubstrings,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oDSubstrings);
-         *poDComponents = NULL;
-         return BAD_PATH;
+   /* the remaining bytes, fewer than a word */
+   for(; ulIndex < ulLength; ulIndex++) {
+      if(pcPath[ulIndex] == '/') {
+         if(pcPath[ulIndex - 1] == '/')
+            return BAD_PATH;
+         ulSlashes++;
       }
+   }
 
-      /* advance pcEnd to end of next token */
-      while(*pcEnd != '/' && *pcEnd != '\0')
-         pcEnd++;
-
-      /* final component can't end with slash */
-      if(*pcEnd == '\0' && *(pcEnd-1) == '/') {
-         DynArray_map(oDSubstrings,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oDSubstrings);
-         *poDComponents = NULL;
-         return BAD_PATH;
-      }
+   *pulDepth = ulSlashes + 1;
+   return SUCCESS;
+}
 
-      pcCopy = calloc((size_t)(pcEnd-pcStart+1), sizeof(char));
-      if(pcCopy == NULL) {
-         DynArray_map(oDSubstrings,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oDSubstrings);
-         *poDComponents = NULL;
-         return MEMORY_ERROR;
-      }
+#else
 
-      if( DynArray_add(oDSubstrings, pcCopy) == 0) {
-         DynArray_map(oDSubstrings,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oDSubstrings);
-         *poDComponents = NULL;
-         return MEMORY_ERROR;
-      }
+static int Path_validate(const char *pcPath, size_t ulLength,
+                         size_t *pulDepth) {
+   size_t ulIndex;
+   size_t ulDepth = 1;
 
-      while(pcStart != pcEnd) {
-         *pcCopy = *pcStart;
-         pcCopy++;
-         pcStart++;
-      }
+   assert(pcPath != NULL);
+   assert(pulDepth != NULL);
 
-      pcStart++;
+   /* path cannot be empty string, nor start with a delimiter */
+   if(ulLength == 0 || pcPath[0] == '/')
+      return BAD_PATH;
+
+   for(ulIndex = 0; ulIndex < ulLength; ulIndex++) {
+      if(pcPath[ulIndex] == '/') {
+         /* a delimiter must be followed by a non-empty component */
+         if(ulIndex + 1 == ulLength || pcPath[ulIndex + 1] == '/')
+            return BAD_PATH;
+         ulDepth++;
+      }
    }
 
-   *poDComponents = oDSubstrings;
+   *pulDepth = ulDepth;
    return SUCCESS;
 }
 
+#endif
+
+unsigned long long Path_extendHash(unsigned long long ullPrefix,
+                                   unsigned long long ullComponent) {
+   return ullPrefix * 0x9E3779B97F4A7C15ULL ^ ullComponent;
+}
+
+unsigned long long Path_retractHash(unsigned long long ullHash,
+                                    unsigned long long ullComponent) {
+   /* the multiplier is odd, so this is its inverse modulo 2^64 */
+   return (ullHash ^ ullComponent) * 0xF1DE83E19937733DULL;
+}
+
+/* Returns whether a path of ulDepth components and ulLength bytes
+   is stored in an inline block. */
+static boolean Path_isInline(size_t ulDepth, size_t ulLength) {
+   return ulDepth <= INLINE_DEPTH && ulLength <= INLINE_LENGTH;
+}
+
+/* Returns the size of the block for a path that owns its tables and
+   has ulDepth components and ulLength bytes. */
+static size_t Path_blockSize(size_t ulDepth, size_t ulLength) {
+   return HASH_OFFSET + ulDepth * (sizeof(unsigned long long) +
+                                   sizeof(const char *)) + ulLength + 1;
+}
+
+/*
+  Lays out psNew, whose bInline is set, as a path owning its tables and
+  holding the ulLength bytes at pcPath, a well-formatted path of
+  ulDepth components. The components are not yet interned: entry i of
+  the component table points at the start of component i in psNew's
+  own pathname, and entry i of the hash table holds that component's
+  Intern_hash, until Path_internComponents replaces them. Touches no
+  shared state, so it may run on any thread.
+*/
+static void Path_scan(struct path *psNew, const char *pcPath,
+                      size_t ulLength, size_t ulDepth) {
+   const char *pcStart, *pcEnd, *pcLimit;
+   char *pcCopy;
+   size_t ulIndex;
+
+   assert(psNew != NULL);
+   assert(pcPath != NULL);
+
+   psNew->pullHashes =
+      (unsigned long long *) (void *) ((char *) psNew + HASH_OFFSET);
+   psNew->ppcComponents =
+      (const char **) (void *) (psNew->pullHashes + ulDepth);
+   pcCopy = (char *) (psNew->ppcComponents + ulDepth);
+   memcpy(pcCopy, pcPath, ulLength);
+   pcCopy[ulLength] = '\0';
+
+   psNew->ulRefCount = 1;
+   psNew->pcPath = pcCopy;
+   psNew->ulLength = ulLength;
+   psNew->ulDepth = ulDepth;
+   psNew->oPBase = NULL;
+
+   pcStart = pcCopy;
+   pcLimit = pcCopy + ulLength;
+   for(ulIndex = 0; ulIndex < ulDepth; ulIndex++) {
+      /* advance pcEnd to end of next token */
+      pcEnd = memchr(pcStart, '/', (size_t) (pcLimit - pcStart));
+      if(pcEnd == NULL)
+         pcEnd = pcLimit;
+
+      psNew->ppcComponents[ulIndex] = pcStart;
+      psNew->pullHashes[ulIndex] =
+         Intern_hash(pcStart, (size_t) (pcEnd - pcStart));
+      pcStart = pcEnd + 1;
+   }
+}
+
+/*
+  Finishes psNew, as laid out by Path_scan, by interning each of its
+  components, taking one reference to each, and replacing each
+  component's hash with the hash of the prefix ending there.
+  Returns one of the following statuses:
+  * SUCCESS if no error occurrs
+  * MEMORY_ERROR if memory could not be allocated to complete request,
+                 in which case no references are left held
+*/
+static int Path_internComponents(struct path *psNew) {
+   const char **ppcComponents;
+   const char *pcEnd;
+   size_t ulIndex;
+   unsigned long long ullHash = 0;
+
+   assert(psNew != NULL);
+
+   ppcComponents = psNew->ppcComponents;
+   for(ulIndex = 0; ulIndex < psNew->ulDepth; ulIndex++) {
+      /* the component ends at the delimiter before the next one */
+      if(ulIndex + 1 < psNew->ulDepth)
+         pcEnd = ppcComponents[ulIndex + 1] - 1;
+      else
+         pcEnd = psNew->pcPath + psNew->ulLength;
+
+      ppcComponents[ulIndex] =
+         Intern_stringHashed(ppcComponents[ulIndex],
+                             (size_t) (pcEnd - ppcComponents[ulIndex]),
+                             psNew->pullHashes[ulIndex]);
+      if(ppcComponents[ulIndex] == NULL) {
+         while(ulIndex > 0)
+            Intern_release(ppcComponents[--ulIndex]);
+         return MEMORY_ERROR;
+      }
+      ullHash = Path_extendHash(ullHash, psNew->pullHashes[ulIndex]);
+      psNew->pullHashes[ulIndex] = ullHash;
+   }
+   return SUCCESS;
+}
 
 int Path_new(const char *pcPath, Path_T *poPResult) {
+   assert(pcPath != NULL);
+   assert(poPResult != NULL);
+
+   return Path_newN(pcPath, strlen(pcPath), poPResult);
+}
+
+int Path_newN(const char *pcPath, size_t ulLength, Path_T *poPResult) {
    struct path *psNew;
-   int iSplitResult;
+   const char *pcNul;
+   size_t ulDepth;
+   int iStatus;
 
    assert(pcPath != NULL);
    assert(poPResult != NULL);
 
-   psNew = calloc(1, sizeof(struct path));
-   if(psNew == NULL) {
+   /* the path ends at any '\0' in the range */
+   pcNul = memchr(pcPath, '\0', ulLength);
+   if(pcNul != NULL)
+      ulLength = (size_t) (pcNul - pcPath);
+
+   iStatus = Path_validate(pcPath, ulLength, &ulDepth);
+   if(iStatus != SUCCESS) {
       *poPResult = NULL;
-      return MEMORY_ERROR;
+      return iStatus;
    }
 
-   /* instantiate and fill list of components */
-   iSplitResult = Path_split(pcPath, &psNew->oDComponents);
-   if(iSplitResult != SUCCESS) {
-      Path_free(psNew);
+   /* one block: header, hash table, component table, pathname */
+   psNew = Path_allocBlock(Path_isInline(ulDepth, ulLength),
+                           Path_blockSize(ulDepth, ulLength));
+   if(psNew == NULL) {
       *poPResult = NULL;
-      return iSplitResult;
+      return MEMORY_ERROR;
    }
 
-   psNew->ulLength = strlen(pcPath);
-   psNew->pcPath = malloc(psNew->ulLength+1);
-   if(psNew->pcPath == NULL) {
-      Path_free(psNew);
+   /* instantiate and fill tables of components and hashes */
+   Path_scan(psNew, pcPath, ulLength, ulDepth);
+   iStatus = Path_internComponents(psNew);
+   if(iStatus != SUCCESS) {
+      Path_freeBlock(psNew);
       *poPResult = NULL;
-      return MEMORY_ERROR;
+      return iStatus;
    }
-   strcpy((char *)psNew->pcPath, pcPath);
 
    *poPResult = psNew;
    return SUCCESS;
 }
 
+/* The fewest paths a batch gives each worker thread, so that small
+   batches are not slowed by starting threads */
+enum { MIN_BATCH_CHUNK = 4096 };
+
+/* The most worker threads one batch uses */
+enum { MAX_BATCH_WORKERS = 16 };
+
+/* One worker's share of a batch: entries ulFirst to ulLast - 1 */
+struct batchChunk {
+   /* the batch's paths as strings, or NULL if it is a buffer */
+   const char *const *ppcPaths;
+   /* the batch's buffer of newline-delimited paths, if ppcPaths is
+      NULL, and the offset in it at which each entry starts; entry i
+      ends just before the delimiter at offset pulStarts[i + 1] - 1 */
+   const char *pcBuffer;
+   const size_t *pulStarts;
+   /* the batch's result and status arrays */
+   Path_T *poPResults;
+   int *piStatuses;
+   size_t ulFirst;
+   size_t ulLast;
+};
+
+/*
+  Validates and lays out (with Path_scan) each path in the chunk of a
+  batch that pvChunk, a struct batchChunk, describes, storing each
+  status and new block in the batch's arrays. Blocks come straight from
+  malloc, as the free list is not shared between threads. Touches no
+  shared state, so chunks may run on separate threads. Returns NULL.
+*/
+static void *Path_batchWorker(void *pvChunk) {
+   struct batchChunk *psChunk = pvChunk;
+   const char *pcPath, *pcNul;
+   size_t ulIndex, ulLength, ulDepth;
+   boolean bInline;
+   struct path *psNew;
+
+   assert(psChunk != NULL);
+
+   for(ulIndex = psChunk->ulFirst; ulIndex < psChunk->ulLast; ulIndex++) {
+      psChunk->poPResults[ulIndex] = NULL;
+
+      if(psChunk->ppcPaths != NULL) {
+         pcPath = psChunk->ppcPaths[ulIndex];
+         ulLength = strlen(pcPath);
+      }
+      else {
+         pcPath = psChunk->pcBuffer + psChunk->pulStarts[ulIndex];
+         ulLength = psChunk->pulStarts[ulIndex + 1] - 1 -
+            psChunk->pulStarts[ulIndex];
+         /* as with Path_new, the path ends at any '\0' */
+         pcNul = memchr(pcPath, '\0', ulLength);
+         if(pcNul != NULL)
+            ulLength = (size_t) (pcNul - pcPath);
+      }
+
+      psChunk->piStatuses[ulIndex] =
+         Path_validate(pcPath, ulLength, &ulDepth);
+      if(psChunk->piStatuses[ulIndex] != SUCCESS)
+         continue;
+
+      bInline = Path_isInline(ulDepth, ulLength);
+      if(bInline)
+         psNew = malloc(INLINE_SIZE);
+      else
+         psNew = malloc(Path_blockSize(ulDepth, ulLength));
+      if(psNew == NULL) {
+         psChunk->piStatuses[ulIndex] = MEMORY_ERROR;
+         continue;
+      }
+      psNew->bInline = bInline;
+      Path_scan(psNew, pcPath, ulLength, ulDepth);
+      psChunk->poPResults[ulIndex] = psNew;
+   }
+   return NULL;
+}
+
+/*
+  Makes the ulCount paths of a batch, given either as the strings in
+  ppcPaths or, if ppcPaths is NULL, as the entries of pcBuffer at the
+  offsets in pulStarts (see struct batchChunk). The slow part, checking
+  and laying out each path, is split among worker threads; interning,
+  which uses the shared table, then runs on this thread in entry order.
+  Fills poPResults and piStatuses as Path_newBatch describes and
+  returns the same status.
+*/
+static int Path_runBatch(const char *const *ppcPaths,
+                         const char *pcBuffer, const size_t *pulStarts,
+                         size_t ulCount, Path_T *poPResults,
+                         int *piStatuses) {
+   struct batchChunk asChunks[MAX_BATCH_WORKERS];
+   pthread_t aThreads[MAX_BATCH_WORKERS];
+   boolean abStarted[MAX_BATCH_WORKERS];
+   size_t ulWorkers, ulWorker, ulIndex;
+   long lCpus;
+   int iResult = SUCCESS;
+
+   lCpus = sysconf(_SC_NPROCESSORS_ONLN);
+   ulWorkers = ulCount / MIN_BATCH_CHUNK;
+   if(lCpus > 0 && ulWorkers > (size_t) lCpus)
+      ulWorkers = (size_t) lCpus;
+   if(ulWorkers > MAX_BATCH_WORKERS)
+      ulWorkers = MAX_BATCH_WORKERS;
+   if(ulWorkers == 0)
+      ulWorkers = 1;
+
+   /* worker 0 is this thread; a worker that cannot be started has its
+      chunk run here too */
+   for(ulWorker = 0; ulWorker < ulWorkers; ulWorker++) {
+      asChunks[ulWorker].ppcPaths = ppcPaths;
+      asChunks[ulWorker].pcBuffer = pcBuffer;
+      asChunks[ulWorker].pulStarts = pulStarts;
+      asChunks[ulWorker].poPResults = poPResults;
+      asChunks[ulWorker].piStatuses = piStatuses;
+      asChunks[ulWorker].ulFirst = ulCount * ulWorker / ulWorkers;
+      asChunks[ulWorker].ulLast = ulCount * (ulWorker + 1) / ulWorkers;
+      abStarted[ulWorker] = ulWorker > 0 &&
+         pthread_create(&aThreads[ulWorker], NULL, Path_batchWorker,
+                        &asChunks[ulWorker]) == 0;
+   }
+   for(ulWorker = 0; ulWorker < ulWorkers; ulWorker++) {
+      if(abStarted[ulWorker])
+         (void) pthread_join(aThreads[ulWorker], NULL);
+      else
+         (void) Path_batchWorker(&asChunks[ulWorker]);
+   }
+
+   for(ulIndex = 0; ulIndex < ulCount; ulIndex++) {
+      struct path *psNew = (struct path *) poPResults[ulIndex];
+
+      if(psNew != NULL) {
+         piStatuses[ulIndex] = Path_internComponents(psNew);
+         if(piStatuses[ulIndex] != SUCCESS) {
+            Path_freeBlock(psNew);
+            poPResults[ulIndex] = NULL;
+         }
+         else if(psNew->bInline)
+            sStats.ulInline++;
+         else
+            sStats.ulSpilled++;
+      }
+      if(piStatuses[ulIndex] != SUCCESS && iResult == SUCCESS)
+         iResult = piStatuses[ulIndex];
+   }
+   return iResult;
+}
+
+int Path_newBatch(const char *const *ppcPaths, size_t ulCount,
+                  Path_T *poPResults, int *piStatuses) {
+   assert(ppcPaths != NULL || ulCount == 0);
+   assert(poPResults != NULL || ulCount == 0);
+   assert(piStatuses != NULL || ulCount == 0);
+
+   return Path_runBatch(ppcPaths, NULL, NULL, ulCount, poPResults,
+                        piStatuses);
+}
+
+int Path_newBatchLines(const char *pcBuffer, size_t ulLength,
+                       Path_T **ppoPResults, int **ppiStatuses,
+                       size_t *pulCount) {
+   size_t *pulStarts;
+   const char *pcNewline;
+   size_t ulCount, ulOffset;
+   int iStatus;
+
+   assert(pcBuffer != NULL || ulLength == 0);
+   assert(ppoPResults != NULL);
+   assert(ppiStatuses != NULL);
+   assert(pulCount != NULL);
+
+   *ppoPResults = NULL;
+   *ppiStatuses = NULL;
+   *pulCount = 0;
+
+   /* count the entries: one per line, a final '\n' ending the last */
+   ulCount = 0;
+   for(ulOffset = 0; ulOffset < ulLength; ulOffset =
+          (size_t) (pcNewline - pcBuffer) + 1) {
+      pcNewline = memchr(pcBuffer + ulOffset, '\n', ulLength - ulOffset);
+      if(pcNewline == NULL)
+         pcNewline = pcBuffer + ulLength;
+      ulCount++;
+   }
+
+   /* no entries: no arrays to make */
+   if(ulCount == 0)
+      return SUCCESS;
+
+   /* ulCount is at most ulLength, so only the products can overflow */
+   if(ulCount > SIZE_MAX / sizeof(Path_T) ||
+      ulCount > SIZE_MAX / sizeof(int) ||
+      ulCount > SIZE_MAX / sizeof(size_t) - 1)
+      return MEMORY_ERROR;
+
+   pulStarts = malloc((ulCount + 1) * sizeof(size_t));
+   *ppoPResults = malloc(ulCount * sizeof(Path_T));
+   *ppiStatuses = malloc(ulCount * sizeof(int));
+   if(pulStarts == NULL || *ppoPResults == NULL || *ppiStatuses == NULL) {
+      free(pulStarts);
+      free(*ppoPResults);
+      free(*ppiStatuses);
+      *ppoPResults = NULL;
+      *ppiStatuses = NULL;
+      return MEMORY_ERROR;
+   }
+
+   /* record where each entry starts, and where one past the last
+      would, as if the buffer ended with a '\n' */
+   ulCount = 0;
+   for(ulOffset = 0; ulOffset < ulLength; ulOffset =
+          (size_t) (pcNewline - pcBuffer) + 1) {
+      pcNewline = memchr(pcBuffer + ulOffset, '\n', ulLength - ulOffset);
+      if(pcNewline == NULL)
+         pcNewline = pcBuffer + ulLength;
+      pulStarts[ulCount++] = ulOffset;
+   }
+   pulStarts[ulCount] = ulOffset;
+
+   iStatus = Path_runBatch(NULL, pcBuffer, pulStarts, ulCount,
+                           *ppoPResults, *ppiStatuses);
+   free(pulStarts);
+   *pulCount = ulCount;
+   return iStatus;
+}
+
 int Path_prefix(Path_T oPPath, size_t ulDepth, Path_T *poPResult) {
    struct path *psNew;
-   size_t ulIndex, ulLength, ulSum;
-   const char *pcComponent;
-   char *pcCopy;
+   size_t ulIndex, ulSum;
    char *pcBuild;
-   char *pcInsert;
 
    assert(oPPath != NULL);
    assert(poPResult != NULL);
@@ -175,60 +633,42 @@ int Path_prefix(Path_T oPPath, size_t ulDepth, Path_T *poPResult) {
       return NO_SUCH_PATH;
    }
 
-   psNew = calloc(1, sizeof(struct path));
-   if(psNew == NULL) {
-      *poPResult = NULL;
-      return MEMORY_ERROR;
-   }
-
-   psNew->oDComponents = DynArray_new(ulDepth);
-   if(psNew->oDComponents == NULL) {
-      Path_free(psNew);
-      *poPResult = NULL;
-      return MEMORY_ERROR;
-   }
-
-   pcBuild = calloc(Path_getStrLength(oPPath)+1, sizeof(char));
-   if(pcBuild == NULL) {
-      Path_free(psNew);
-      *poPResult = NULL;
-      return MEMORY_ERROR;
+   /* the whole path: share it outright */
+   if(Path_getDepth(oPPath) == ulDepth) {
+      ((struct path *) oPPath)->ulRefCount++;
+      *poPResult = oPPath;
+      return SUCCESS;
    }
 
-   pcInsert = pcBuild;
-   ulSum = 0;
+   /* prefix's pathname is the first ulSum characters of oPPath's:
+      its components plus a delimiter between each pair */
+   ulSum = ulDepth - 1;
+   for(ulIndex = 0; ulIndex < ulDepth; ulIndex++)
+      ulSum += Intern_getLength(oPPath->ppcComponents[ulIndex]);
 
-   for(ulIndex = 0; ulIndex < ulDepth; ulIndex++) {
-      /* deep copy each component to new DynArray */
-      pcComponent = Path_getComponent(oPPath, ulIndex);
-      ulLength = strlen(pcComponent);
-      pcCopy = calloc(ulLength + 1, sizeof(char));
-      if(pcCopy == NULL) {
-         free(pcBuild);
-         Path_free(psNew);
-         *poPResult = NULL;
-         return MEMORY_ERROR;
-      }
-      strcpy(pcCopy, pcComponent);
-      (void) DynArray_set(psNew->oDComponents, ulIndex, pcCopy);
-      /* construct prefix's pathname string */
-      strcpy(pcInsert, pcComponent);
-      pcInsert[ulLength] = '/';
-      ulSum += ulLength + 1;
-      pcInsert += ulLength + 1;
-   }
-   pcBuild[ulSum-1] = '\0';
-
-   /* shrink allocation to fit prefix's pathname string if needed */
-   pcInsert = realloc(pcBuild, ulSum);
-   if(pcInsert == NULL) {
-      free(pcBuild);
-      Path_free(psNew);
+   /* one block: header, pathname */
+   psNew = Path_allocBlock(ulSum <= INLINE_LENGTH,
+                           sizeof(struct path) + ulSum + 1);
+   if(psNew == NULL) {
       *poPResult = NULL;
       return MEMORY_ERROR;
    }
-   psNew->ulLength = ulSum-1;
-   psNew->pcPath = pcInsert;
+   pcBuild = (char *) (psNew + 1);
+   memcpy(pcBuild, oPPath->pcPath, ulSum);
+   pcBuild[ulSum] = '\0';
+
+   /* share the table of the path that owns it */
+   if(oPPath->oPBase != NULL)
+      oPPath = oPPath->oPBase;
+   ((struct path *) oPPath)->ulRefCount++;
+   psNew->oPBase = oPPath;
+   psNew->ppcComponents = oPPath->ppcComponents;
+   psNew->pullHashes = oPPath->pullHashes;
+
+   psNew->ulRefCount = 1;
+   psNew->pcPath = pcBuild;
+   psNew->ulLength = ulSum;
+   psNew->ulDepth = ulDepth;
 
    *poPResult = psNew;
    return SUCCESS;
@@ -242,16 +682,25 @@ int Path_dup(Path_T oPPath, Path_T *poPResult) {
 }
 
 void Path_free(Path_T oPPath) {
-   if(oPPath != NULL) {
-      free((char *)oPPath->pcPath);
+   struct path *psPath = (struct path *) oPPath;
+   size_t ulIndex;
 
-      if(oPPath->oDComponents != NULL) {
-         DynArray_map(oPPath->oDComponents,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oPPath->oDComponents);
-      }
+   if(psPath == NULL)
+      return;
+
+   /* only the last holder frees */
+   if(psPath->ulRefCount > 1) {
+      psPath->ulRefCount--;
+      return;
+   }
+
+   if(psPath->oPBase != NULL)
+      Path_free(psPath->oPBase);
+   else {
+      for(ulIndex = 0; ulIndex < psPath->ulDepth; ulIndex++)
+         Intern_release(psPath->ppcComponents[ulIndex]);
    }
-   free((struct path*) oPPath);
+   Path_freeBlock(psPath);
 }
 
 const char *Path_getPathname(Path_T oPPath) {
@@ -270,6 +719,14 @@ int Path_comparePath(Path_T oPPath1, Path_T oPPath2) {
    assert(oPPath1 != NULL);
    assert(oPPath2 != NULL);
 
+   /* a path and its copies, or two equal-depth prefixes of one path,
+      are equal without reading either pathname */
+   if(oPPath1->ppcComponents == oPPath2->ppcComponents &&
+      oPPath1->ulDepth == oPPath2->ulDepth)
+      return 0;
+
+   /* a hash can rule out equality but cannot give an order, so the
+      pathnames decide */
    return strcmp(oPPath1->pcPath, oPPath2->pcPath);
 }
 
@@ -283,7 +740,7 @@ int Path_compareString(Path_T oPPath, const char *pcStr) {
 size_t Path_getDepth(Path_T oPPath) {
    assert(oPPath != NULL);
 
-   return DynArray_getLength(oPPath->oDComponents);
+   return oPPath->ulDepth;
 }
 
 size_t Path_getSharedPrefixDepth(Path_T oPPath1, Path_T oPPath2) {
@@ -298,19 +755,36 @@ size_t Path_getSharedPrefixDepth(Path_T oPPath1, Path_T oPPath2) {
       ulMin = ulDepth1;
    else
       ulMin = ulDepth2;
+   /* prefixes of one path share its tables */
+   if(oPPath1->ppcComponents == oPPath2->ppcComponents)
+      return ulMin;
+   /* components are interned: equal strings are the same pointer, so
+      no component bytes are read */
    for(i = 0; i < ulMin; i++) {
-      if(strcmp(Path_getComponent(oPPath1, i),
-                Path_getComponent(oPPath2, i)))
+      if(Path_getComponent(oPPath1, i) != Path_getComponent(oPPath2, i))
          return i;
    }
    return ulMin;
 }
 
+unsigned long long Path_getPrefixHash(Path_T oPPath, size_t ulDepth) {
+   assert(oPPath != NULL);
+   assert(ulDepth >= 1 && ulDepth <= Path_getDepth(oPPath));
+
+   return oPPath->pullHashes[ulDepth - 1];
+}
+
 const char *Path_getComponent(Path_T oPPath, size_t ulLevel) {
    assert(oPPath != NULL);
 
    if(ulLevel >= Path_getDepth(oPPath))
       return NULL;
 
-   return DynArray_get(oPPath->oDComponents, ulLevel);
+   return oPPath->ppcComponents[ulLevel];
+}
+
+void Path_getStats(struct Path_Stats *psStats) {
+   assert(psStats != NULL);
+
+   *psStats = sStats;
 }
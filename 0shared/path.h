@@ -9,9 +9,38 @@
 #include <stddef.h>
 #include "a4def.h"
 
-/* An object representing an absolute path in a tree */
+/* An object representing an absolute path in a tree. Path objects are
+   immutable, so copies and prefixes share storage with the path they
+   came from; each holder still releases its own with Path_free. The
+   holders of shared storage share one reference count, which is not
+   updated atomically: a copy handed to another thread still shares
+   it with the original, so Path_dup, Path_prefix and Path_free on
+   the two must not overlap. */
 typedef const struct path * Path_T;
 
+/* The path module keeps state shared by the whole process, with no
+   lock: the free list of blocks that freed paths leave for new ones,
+   the counters Path_getStats reports, and the intern table the
+   components are kept in. So, as with Intern_string, Path_new,
+   Path_newN, Path_newBatch, Path_newBatchLines, Path_prefix, Path_dup
+   and Path_free must not run on more than one thread at a time, even
+   on unrelated paths; Path_newBatch and Path_newBatchLines use threads
+   of their own only for work that touches none of this state. The
+   functions that only read a path may run on any number of threads. */
+
+/* Counters describing how paths have been stored */
+struct Path_Stats {
+   /* the number of paths (including prefixes) built in a fixed-size
+      inline block */
+   size_t ulInline;
+   /* the number of paths too long or too deep for an inline block,
+      each built in a block allocated to fit */
+   size_t ulSpilled;
+   /* the number of inline blocks reused from a freed path rather than
+      allocated */
+   size_t ulRecycled;
+};
+
 /*
   Creates a new path object representing the absolute path in pcPath.
   Returns an int SUCCESS status and sets *poPResult to be the new path
@@ -24,7 +53,45 @@ typedef const struct path * Path_T;
 int Path_new(const char *pcPath, Path_T *poPResult);
 
 /*
-  Creates a "deep copy" of oPPath, duplicating all its contents.
+  Does the same as Path_new for the path in the ulLength bytes at
+  pcPath, which need not be '\0'-terminated. The path ends early at a
+  '\0' within those bytes, if there is one; no byte past them is read.
+  The bytes are only borrowed: the new path holds its own copy.
+*/
+int Path_newN(const char *pcPath, size_t ulLength, Path_T *poPResult);
+
+/*
+  Creates a path object for each of the ulCount strings in ppcPaths,
+  as Path_new would, setting poPResults[i] to the path made from
+  ppcPaths[i] (or NULL) and piStatuses[i] to the status Path_new would
+  have returned for it. Large batches are checked and laid out on
+  several threads at once; the paths themselves are the same as
+  Path_new's. Each path made is freed with Path_free as usual.
+  Returns SUCCESS if every path was made, and otherwise the status of
+  the first that was not.
+*/
+int Path_newBatch(const char *const *ppcPaths, size_t ulCount,
+                  Path_T *poPResults, int *piStatuses);
+
+/*
+  Does the same as Path_newBatch for the paths in the ulLength bytes at
+  pcBuffer, one per line: each '\n' ends an entry, as does the end of
+  the buffer if the last entry has no '\n'. As in Path_new, an entry
+  also ends at any '\0' in it, and an empty entry is a BAD_PATH.
+  Sets *pulCount to the number of entries and *ppoPResults and
+  *ppiStatuses to new arrays of that length, which the caller frees
+  with free. An empty buffer has no entries, and so leaves both
+  arrays NULL and returns SUCCESS. Returns MEMORY_ERROR, with
+  *pulCount 0 and both arrays NULL, if the arrays could not be
+  allocated, and otherwise as Path_newBatch.
+*/
+int Path_newBatchLines(const char *pcBuffer, size_t ulLength,
+                       Path_T **ppoPResults, int **ppiStatuses,
+                       size_t *pulCount);
+
+/*
+  Creates a copy of oPPath. As paths are immutable, this just takes
+  another reference to oPPath's storage, in constant time.
   Returns an int SUCCESS status and sets *poPResult to be the new path
   if successful. Otherwise, sets *poPResult to NULL and returns status:
   * MEMORY_ERROR if memory could not be allocated to complete request
@@ -35,7 +102,8 @@ int Path_dup(Path_T oPPath, Path_T *poPResult);
 /*
   Creates a new path object representing a prefix (i.e., ancestor) of
   oPPath with depth ulDepth. In the case that ulDepth is the same as
-  oPPath's depth, this is equivalent to Path_dup.
+  oPPath's depth, this is equivalent to Path_dup. Otherwise the new
+  path shares oPPath's components and copies only the pathname string.
   Returns an int SUCCESS status and sets *poPResult to be the new path
   if successful. Otherwise, sets *poPResult to NULL and returns status:
   * MEMORY_ERROR if memory could not be allocated to complete request
@@ -44,7 +112,10 @@ int Path_dup(Path_T oPPath, Path_T *poPResult);
 /* cuts off given path to given depth level and stores in poPREsult*/
 int Path_prefix(Path_T oPPath, size_t ulDepth, Path_T *poPResult);
 
-/* Destroys and frees all memory allocated for oPPath. */
+/*
+  Releases this holder's reference to oPPath, destroying and freeing
+  all memory allocated for it once no holder (copy or prefix) remains.
+*/
 void Path_free(Path_T oPPath);
 
 /* Returns the string representation of the absolute path oPPath. */
@@ -86,6 +157,34 @@ size_t Path_getDepth(Path_T oPPath);
 */
 size_t Path_getSharedPrefixDepth(Path_T oPPath1, Path_T oPPath2);
 
+/*
+  Returns a 64-bit hash of the prefix of oPPath with depth ulDepth,
+  which must be between 1 and oPPath's depth. It is computed once, when
+  the path is made, from the components' interned hashes, so equal
+  prefixes of any two paths have equal hashes and, barring collisions,
+  unequal prefixes have unequal ones.
+*/
+unsigned long long Path_getPrefixHash(Path_T oPPath, size_t ulDepth);
+
+/*
+  Returns the hash Path_getPrefixHash gives a prefix one component
+  deeper than one that hashes to ullPrefix, when that component's
+  Intern_hash is ullComponent. The hash of a depth-1 prefix extends 0.
+  This lets a caller hash a path component by component, as it finds
+  them, without making a Path_T.
+*/
+unsigned long long Path_extendHash(unsigned long long ullPrefix,
+                                   unsigned long long ullComponent);
+
+/*
+  Returns the hash of the prefix that Path_extendHash extended by a
+  component hashing to ullComponent to give ullHash: the inverse of
+  Path_extendHash, so that a caller walking a tree can climb back up
+  with no stack of the hashes above it.
+*/
+unsigned long long Path_retractHash(unsigned long long ullHash,
+                                    unsigned long long ullComponent);
+
 /*
   Returns the string version of the component of oPPath at level
   ulLevel. This count is from 0, so with level 0 the root of oPPath
@@ -94,4 +193,7 @@ size_t Path_getSharedPrefixDepth(Path_T oPPath1, Path_T oPPath2);
 */
 const char *Path_getComponent(Path_T oPPath, size_t ulLevel);
 
+/* Fills *psStats with the path module's current counters. */
+void Path_getStats(struct Path_Stats *psStats);
+
 #endif
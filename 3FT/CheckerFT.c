@@ -9,7 +9,6 @@
 
 #include "checkerFT.h"
 #include "dynarray.h"
-#include "path.h"
 
 
 /* preceptor ask: decide if including arguements in error messages is worth it*/
@@ -20,10 +19,12 @@ boolean CheckerFT_Node_isValid(Node_T oNNode) {
    Node_T oNodeChild = NULL;
    Node_T oChildParent = NULL;
 
-   Path_T oNodePath = NULL; 
-   Path_T oParentPath = NULL;
-   Path_T oChildPath = NULL;
-   Path_T oPrevChildPath = NULL;
+   /* nodes store only their own component, so the checks below are
+      made on names and depths rather than on full paths */
+   const char *pcName = NULL;
+   const char *pcChildName = NULL;
+   const char *pcPrevChildName = NULL;
+   boolean bPrevChildIsFile = TRUE;
    
    size_t ulChildIdx = 0;
    size_t ulChildDepth = 0;
@@ -36,27 +37,33 @@ boolean CheckerFT_Node_isValid(Node_T oNNode) {
       return FALSE;
    }
 
-   /* Node must have a valid path */
-   oNodePath = Node_getPath(oNNode);
-   if(oNodePath == NULL) {
-      fprintf(stderr, "A node has a NULL path\n");
+   /* Node must have a valid name */
+   pcName = Node_getName(oNNode);
+   if(pcName == NULL) {
+      fprintf(stderr, "A node has a NULL name\n");
       return FALSE;
    }
 
-   /* Empty path is invalid */
-   if (strcmp(Path_getPathname(oNodePath), "") == 0) {
-      fprintf(stderr, "A node has an empty string as its path\n");
+   /* Empty name is invalid */
+   if (strcmp(pcName, "") == 0) {
+      fprintf(stderr, "A node has an empty string as its name\n");
       return FALSE;
    }
 
-   ulNodeDepth = Path_getDepth(oNodePath);
+   /* a name is a single component, so it cannot hold a delimiter */
+   if (strchr(pcName, '/') != NULL) {
+      fprintf(stderr, "A node's name (%s) contains a '/'\n", pcName);
+      return FALSE;
+   }
+
+   ulNodeDepth = Node_getDepth(oNNode);
    oNodeParent = Node_getParent(oNNode);
    
    if(oNodeParent != NULL) {
       /* Invariant: Files cannot have children*/
       if(Node_isFile(oNodeParent)) {
          fprintf(stderr, "File node incorrectly has child (%s)\n",
-                 Path_getPathname(oNodePath));
+                 pcName);
          return FALSE;
       }
 
@@ -64,31 +71,21 @@ boolean CheckerFT_Node_isValid(Node_T oNNode) {
          fprintf(stderr, "A node has a non-NULL parent but depth is 1\n");
          return FALSE;
       }
-      oParentPath = Node_getPath(oNodeParent);
-      ulParentDepth = Path_getDepth(oParentPath);
-
-      if (Path_getSharedPrefixDepth(oParentPath, oNodePath) != ulNodeDepth - 1) {
-         fprintf(stderr,
-                 "Incorrect parent-child path linkage: Parent node (%s)" 
-                 "is not the immediate prefix path of child path (%s)\n",
-                 Path_getPathname(oParentPath), Path_getPathname(oNodePath));
-         return FALSE;
-      }
+      ulParentDepth = Node_getDepth(oNodeParent);
       
       if (ulNodeDepth != ulParentDepth + 1) {
          fprintf(stderr,
                  "Child depth is not parent depth + 1: Child:"
                  "(%s) depth %lu, Parent: (%s) depth %lu\n",
-                 Path_getPathname(oNodePath), (unsigned long)ulNodeDepth,
-                 Path_getPathname(oParentPath), (unsigned long)ulParentDepth);
+                 pcName, (unsigned long)ulNodeDepth,
+                 Node_getName(oNodeParent), (unsigned long)ulParentDepth);
          return FALSE;
       }
    }
    else {
       /* ask preceptor if this is a valid invariant or whether it can be*/
       if(Node_isFile(oNNode)) {
-         fprintf(stderr, "Root cannot be a file: (%s)\n",
-                 Path_getPathname(oNodePath));
+         fprintf(stderr, "Root cannot be a file: (%s)\n", pcName);
          return FALSE;
       }
       if (ulNodeDepth != 1) {
@@ -101,89 +98,83 @@ boolean CheckerFT_Node_isValid(Node_T oNNode) {
    if(Node_isFile(oNNode)) {
       if(Node_getNumChildren(oNNode) != 0) {
          fprintf(stderr, "File node incorrectly has children: (%s)\n",
-                 Path_getPathname(oNodePath));
+                 pcName);
          return FALSE;
       }
       /* no further checks needed for file nodes since rest check children*/
       return TRUE;
    }
 
-   /* oprevChild path? */
    for(ulChildIdx = 0; ulChildIdx < Node_getNumChildren(oNNode); ulChildIdx++) {
       int iStatus = Node_getChild(oNNode, ulChildIdx, &oNodeChild);
-      if(iStatus != SUCCESS) {
+      if(iStatus != SUCCESS || oNodeChild == NULL) {
          fprintf(stderr, "Child at index %lu is not retrievable\n", 
             (unsigned long)ulChildIdx);
          return FALSE;
       }
 
-      if(Node_getParent(oNodeChild) != oNNode) {
-         fprintf(stderr, "Child's parent mismatch under (%s)\n",
-                 Path_getPathname(oNodePath));
-         return FALSE;
-      }
-
-      oChildPath = Node_getPath(oNodeChild);
-      if(Path_getSharedPrefixDepth(oNodePath, oChildPath) != ulNodeDepth) {
-         fprintf(stderr, "Parent node (%s) returned a NULL child at index %lu\n", 
-            Path_getPathname(oNodePath),(unsigned long)ulChildIdx);
-         return FALSE;
-      }
-
+      /* a child's path is its parent's path plus its own name, so a
+         correct parent pointer is what links the child's path to this
+         node's path */
       oChildParent = Node_getParent(oNodeChild);
       if (oChildParent != oNNode) {
-         const char *childPathStr = "(null)";
-         const char *childParentPathStr = "(null)";
-         const char *thisPathStr = "(null)";
-         if (Node_getPath(oNodeChild) != NULL)
-            childPathStr = Path_getPathname(Node_getPath(oNodeChild));
-         if (oChildParent != NULL && Node_getPath(oChildParent) != NULL)
-            childParentPathStr = Path_getPathname(Node_getPath(oChildParent));
-         if (oNodePath != NULL)
-            thisPathStr = Path_getPathname(oNodePath);
+         const char *childParentName = "(null)";
+         if (oChildParent != NULL)
+            childParentName = Node_getName(oChildParent);
          fprintf(stderr,
                   "Child's parent pointer does not point back to node"
-                 "that has this child: Child path (%s) parent path"
-                 "(%s) vs this node path (%s)\n",
-                 childPathStr, childParentPathStr, thisPathStr);
+                 "that has this child: Child name (%s) parent name"
+                 "(%s) vs this node name (%s)\n",
+                 Node_getName(oNodeChild), childParentName, pcName);
          return FALSE;
       }
       
-      oChildPath = Node_getPath(oNodeChild);
-      if (oChildPath == NULL) {
-         fprintf(stderr, "A child has a NULL path\n");
+      pcChildName = Node_getName(oNodeChild);
+      if (pcChildName == NULL) {
+         fprintf(stderr, "A child has a NULL name\n");
          return FALSE;
       }
 
-      ulChildDepth = Path_getDepth(oChildPath);
+      ulChildDepth = Node_getDepth(oNodeChild);
 
       if (ulNodeDepth != ulChildDepth - 1) {
          fprintf(stderr,
                  "Child depth is not parent depth + 1:"
                  "Child: (%s) depth %lu, Parent: (%s) depth %lu\n",
-                 Path_getPathname(oChildPath), (unsigned long)ulChildDepth,
-                 Path_getPathname(oNodePath), (unsigned long)ulNodeDepth);
+                 pcChildName, (unsigned long)ulChildDepth,
+                 pcName, (unsigned long)ulNodeDepth);
          return FALSE;
       }
 
-      /* since traversal handles the file-directory reordering, 
-      this checker only needs to verify immediate lexigraphic consistent*/
-      if(oPrevChildPath != NULL) {
-         int iCmp = Path_comparePath(oPrevChildPath, oChildPath);
+      /* children are numbered files first, then directories, so a
+      file may not follow a directory, and the lexicographic order is
+      only checked between children of the same type.
+      Siblings share the rest of their paths, so comparing names
+      orders them as comparing full paths would */
+      if(Node_isFile(oNodeChild) && !bPrevChildIsFile) {
+         fprintf(stderr, "File (%s) incorrectly follows a directory"
+                 " among its siblings\n", pcChildName);
+         return FALSE;
+      }
+      if(Node_isFile(oNodeChild) != bPrevChildIsFile)
+         pcPrevChildName = NULL;
+      if(pcPrevChildName != NULL) {
+         int iCmp = strcmp(pcPrevChildName, pcChildName);
          if(iCmp == 0) {
                fprintf(stderr, "Sibling nodes cannot have same name: (%s) appears twice\n",
-               Path_getPathname(oChildPath));
+               pcChildName);
                return FALSE;
             }
          if (iCmp > 0) { 
             fprintf(stderr, "Children not in lexicographic order: (%s)"
             "incorrectly precedes (%s)\n",
-            Path_getPathname(oPrevChildPath), Path_getPathname(oChildPath));
+            pcPrevChildName, pcChildName);
             return FALSE;
          }
       }
 
-      oPrevChildPath = oChildPath;
+      pcPrevChildName = pcChildName;
+      bPrevChildIsFile = Node_isFile(oNodeChild);
    }
 
    return TRUE;
@@ -212,11 +203,8 @@ static boolean CheckerFT_treeCheck(Node_T oNNode, size_t *pulCount) {
 
          int iStatus = Node_getChild(oNNode, ulIndex, &oNodeChild);
          if(iStatus != SUCCESS) {
-            const char *thisPath = "(Null)";
-            if (oNNode != NULL && Node_getPath(oNNode) != NULL) 
-               thisPath = Path_getPathname(Node_getPath(oNNode));
             fprintf(stderr, "Child at index %lu for node %s is not retrievable\n",
-               (unsigned long)ulIndex, thisPath);
+               (unsigned long)ulIndex, Node_getName(oNNode));
             return FALSE;
           }
 
@@ -0,0 +1,873 @@
+/*--------------------------------------------------------------------*/
+/* art.c                                                              */
+/* Author: Zara Hommez                                                */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "art.h"
+
+/* The kinds of node in the tree */
+enum { NODE4, NODE16, NODE48, NODE256, LEAF };
+
+/* The most bytes of a compressed path kept in its node; the rest are
+   read from a leaf below when needed */
+enum { MAX_PREFIX = 8 };
+
+/* The fanouts at which an inner node is replaced by a smaller kind */
+enum { SHRINK16 = 3, SHRINK48 = 12, SHRINK256 = 37 };
+
+/* What every node begins with, so that its kind can be read before
+   the node is converted to its full type */
+struct artNode {
+   /* NODE4, NODE16, NODE48, NODE256 or LEAF */
+   unsigned char ucType;
+};
+
+/* A key and its value. Every key ends in an implicit '\0', so no key
+   is a prefix of another and every key ends at a leaf. */
+struct artLeaf {
+   struct artNode sNode;
+   /* the borrowed bytes of the key, and how many there are */
+   const char *pcKey;
+   size_t ulLength;
+   /* the value stored under the key */
+   void *pvValue;
+};
+
+/* What every inner node begins with */
+struct artInner {
+   struct artNode sNode;
+   /* the number of children */
+   unsigned short usChildren;
+   /* the number of key bytes, shared by everything below this node,
+      that are skipped before this node branches */
+   size_t ulPrefixLength;
+   /* the first of those bytes, up to MAX_PREFIX of them */
+   unsigned char aucPrefix[MAX_PREFIX];
+};
+
+/* An inner node of up to 4 children, with keys in increasing order */
+struct artNode4 {
+   struct artInner sInner;
+   unsigned char aucKeys[4];
+   struct artNode *apsChildren[4];
+};
+
+/* An inner node of up to 16 children, with keys in increasing order */
+struct artNode16 {
+   struct artInner sInner;
+   unsigned char aucKeys[16];
+   struct artNode *apsChildren[16];
+};
+
+/* An inner node of up to 48 children: aucIndex[b] is 1 more than the
+   slot of the child for byte b, or 0 if there is none */
+struct artNode48 {
+   struct artInner sInner;
+   unsigned char aucIndex[256];
+   struct artNode *apsChildren[48];
+};
+
+/* An inner node with a slot for every byte */
+struct artNode256 {
+   struct artInner sInner;
+   struct artNode *apsChildren[256];
+};
+
+struct art {
+   /* the root node, or NULL if the tree is empty */
+   struct artNode *psRoot;
+   /* the number of keys */
+   size_t ulSize;
+   /* the number of bytes allocated, including this struct */
+   size_t ulBytes;
+   /* the region the nodes and this struct come from, or NULL */
+   Region_T oRegion;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Returns byte ulDepth of the ulLength-byte key at pcKey, which is
+   the implicit terminating '\0' if ulDepth is ulLength or more. */
+static unsigned char Art_keyByte(const char *pcKey, size_t ulLength,
+                                 size_t ulDepth) {
+   if(ulDepth < ulLength)
+      return (unsigned char) pcKey[ulDepth];
+   return '\0';
+}
+
+/* Returns the size of a node of kind ucType. */
+static size_t Art_nodeSize(unsigned char ucType) {
+   switch(ucType) {
+      case NODE4:
+         return sizeof(struct artNode4);
+      case NODE16:
+         return sizeof(struct artNode16);
+      case NODE48:
+         return sizeof(struct artNode48);
+      case NODE256:
+         return sizeof(struct artNode256);
+      default:
+         return sizeof(struct artLeaf);
+   }
+}
+
+/* Returns a new inner node of kind ucType with no children and no
+   prefix, or NULL if memory could not be allocated. */
+static struct artInner *Art_newInner(Art_T oArt, unsigned char ucType) {
+   struct artInner *psInner;
+
+   assert(oArt != NULL);
+   assert(ucType != LEAF);
+
+   psInner = Region_alloc(oArt->oRegion, Art_nodeSize(ucType));
+   if(psInner == NULL)
+      return NULL;
+   memset(psInner, 0, Art_nodeSize(ucType));
+   psInner->sNode.ucType = ucType;
+   oArt->ulBytes += Art_nodeSize(ucType);
+   return psInner;
+}
+
+/* Frees psNode, but not its children. */
+static void Art_freeNode(Art_T oArt, struct artNode *psNode) {
+   assert(oArt != NULL);
+   assert(psNode != NULL);
+
+   oArt->ulBytes -= Art_nodeSize(psNode->ucType);
+   Region_release(oArt->oRegion, psNode, Art_nodeSize(psNode->ucType));
+}
+
+/* Frees psNode and everything below it. */
+static void Art_freeTree(Art_T oArt, struct artNode *psNode) {
+   size_t i;
+
+   if(psNode == NULL)
+      return;
+
+   switch(psNode->ucType) {
+      case NODE4: {
+         struct artNode4 *ps = (struct artNode4 *) psNode;
+         for(i = 0; i < ps->sInner.usChildren; i++)
+            Art_freeTree(oArt, ps->apsChildren[i]);
+         break;
+      }
+      case NODE16: {
+         struct artNode16 *ps = (struct artNode16 *) psNode;
+         for(i = 0; i < ps->sInner.usChildren; i++)
+            Art_freeTree(oArt, ps->apsChildren[i]);
+         break;
+      }
+      case NODE48: {
+         struct artNode48 *ps = (struct artNode48 *) psNode;
+         for(i = 0; i < 48; i++)
+            Art_freeTree(oArt, ps->apsChildren[i]);
+         break;
+      }
+      case NODE256: {
+         struct artNode256 *ps = (struct artNode256 *) psNode;
+         for(i = 0; i < 256; i++)
+            Art_freeTree(oArt, ps->apsChildren[i]);
+         break;
+      }
+      default:
+         break;
+   }
+   Art_freeNode(oArt, psNode);
+}
+
+/* Returns TRUE if psLeaf's key is the ulLength bytes at pcKey. */
+static boolean Art_leafMatches(const struct artLeaf *psLeaf,
+                               const char *pcKey, size_t ulLength) {
+   assert(psLeaf != NULL);
+
+   return psLeaf->ulLength == ulLength &&
+      memcmp(psLeaf->pcKey, pcKey, ulLength) == 0;
+}
+
+/* Returns the address of psInner's slot for the child under byte
+   ucByte, or NULL if it has no such child. */
+static struct artNode **Art_findChild(struct artInner *psInner,
+                                      unsigned char ucByte) {
+   size_t i;
+
+   assert(psInner != NULL);
+
+   switch(psInner->sNode.ucType) {
+      case NODE4: {
+         struct artNode4 *ps = (struct artNode4 *) psInner;
+         for(i = 0; i < ps->sInner.usChildren; i++)
+            if(ps->aucKeys[i] == ucByte)
+               return &ps->apsChildren[i];
+         return NULL;
+      }
+      case NODE16: {
+         struct artNode16 *ps = (struct artNode16 *) psInner;
+         for(i = 0; i < ps->sInner.usChildren; i++)
+            if(ps->aucKeys[i] == ucByte)
+               return &ps->apsChildren[i];
+         return NULL;
+      }
+      case NODE48: {
+         struct artNode48 *ps = (struct artNode48 *) psInner;
+         if(ps->aucIndex[ucByte] == 0)
+            return NULL;
+         return &ps->apsChildren[ps->aucIndex[ucByte] - 1];
+      }
+      default: {
+         struct artNode256 *ps = (struct artNode256 *) psInner;
+         if(ps->apsChildren[ucByte] == NULL)
+            return NULL;
+         return &ps->apsChildren[ucByte];
+      }
+   }
+}
+
+/* Returns the leaf with the smallest key at or below psNode. */
+static struct artLeaf *Art_minimum(struct artNode *psNode) {
+   size_t i;
+
+   assert(psNode != NULL);
+
+   for(;;) {
+      switch(psNode->ucType) {
+         case NODE4:
+            psNode = ((struct artNode4 *) psNode)->apsChildren[0];
+            break;
+         case NODE16:
+            psNode = ((struct artNode16 *) psNode)->apsChildren[0];
+            break;
+         case NODE48: {
+            struct artNode48 *ps = (struct artNode48 *) psNode;
+            for(i = 0; ps->aucIndex[i] == 0; i++)
+               ;
+            psNode = ps->apsChildren[ps->aucIndex[i] - 1];
+            break;
+         }
+         case NODE256: {
+            struct artNode256 *ps = (struct artNode256 *) psNode;
+            for(i = 0; ps->apsChildren[i] == NULL; i++)
+               ;
+            psNode = ps->apsChildren[i];
+            break;
+         }
+         default:
+            return (struct artLeaf *) psNode;
+      }
+   }
+}
+
+/* Returns how many bytes of psInner's whole compressed path match the
+   key at pcKey from byte ulDepth on. Bytes past MAX_PREFIX are read
+   from the smallest leaf below psInner, which shares them. */
+static size_t Art_prefixMismatch(struct artInner *psInner,
+                                 const char *pcKey, size_t ulLength,
+                                 size_t ulDepth) {
+   struct artLeaf *psLeaf;
+   size_t ulStored;
+   size_t i;
+
+   assert(psInner != NULL);
+
+   ulStored = psInner->ulPrefixLength;
+   if(ulStored > MAX_PREFIX)
+      ulStored = MAX_PREFIX;
+   for(i = 0; i < ulStored; i++)
+      if(psInner->aucPrefix[i] !=
+         Art_keyByte(pcKey, ulLength, ulDepth + i))
+         return i;
+   if(psInner->ulPrefixLength <= MAX_PREFIX)
+      return i;
+
+   psLeaf = Art_minimum(&psInner->sNode);
+   for(; i < psInner->ulPrefixLength; i++)
+      if(Art_keyByte(psLeaf->pcKey, psLeaf->ulLength, ulDepth + i) !=
+         Art_keyByte(pcKey, ulLength, ulDepth + i))
+         return i;
+   return i;
+}
+
+/* Sets psInner's compressed path to the ulPrefixLength bytes of the
+   key at pcKey starting at byte ulDepth. */
+static void Art_setPrefix(struct artInner *psInner, const char *pcKey,
+                          size_t ulLength, size_t ulDepth,
+                          size_t ulPrefixLength) {
+   size_t i;
+
+   assert(psInner != NULL);
+
+   psInner->ulPrefixLength = ulPrefixLength;
+   for(i = 0; i < ulPrefixLength && i < MAX_PREFIX; i++)
+      psInner->aucPrefix[i] = Art_keyByte(pcKey, ulLength, ulDepth + i);
+}
+
+/* Copies psFrom's header, other than its kind, into psTo. */
+static void Art_copyHeader(struct artInner *psTo,
+                           const struct artInner *psFrom) {
+   assert(psTo != NULL);
+   assert(psFrom != NULL);
+
+   psTo->usChildren = psFrom->usChildren;
+   psTo->ulPrefixLength = psFrom->ulPrefixLength;
+   memcpy(psTo->aucPrefix, psFrom->aucPrefix, MAX_PREFIX);
+}
+
+/* Adds psChild under byte ucByte to the inner node in *ppsNode, which
+   has no child there, replacing it by a larger kind if it is full.
+   Returns TRUE if successful, or FALSE, leaving the node as it was,
+   if memory could not be allocated. */
+static boolean Art_addChild(Art_T oArt, struct artNode **ppsNode,
+                            unsigned char ucByte,
+                            struct artNode *psChild) {
+   struct artInner *psInner = (struct artInner *) *ppsNode;
+   size_t ulChildren = psInner->usChildren;
+   size_t i;
+
+   switch(psInner->sNode.ucType) {
+      case NODE4: {
+         struct artNode4 *ps = (struct artNode4 *) psInner;
+         if(ulChildren < 4) {
+            for(i = ulChildren; i > 0 && ps->aucKeys[i - 1] > ucByte; i--) {
+               ps->aucKeys[i] = ps->aucKeys[i - 1];
+               ps->apsChildren[i] = ps->apsChildren[i - 1];
+            }
+            ps->aucKeys[i] = ucByte;
+            ps->apsChildren[i] = psChild;
+            ps->sInner.usChildren++;
+            return TRUE;
+         }
+         else {
+            struct artNode16 *psNew;
+            psNew = (struct artNode16 *) Art_newInner(oArt, NODE16);
+            if(psNew == NULL)
+               return FALSE;
+            Art_copyHeader(&psNew->sInner, psInner);
+            memcpy(psNew->aucKeys, ps->aucKeys, 4);
+            memcpy(psNew->apsChildren, ps->apsChildren,
+                   4 * sizeof(struct artNode *));
+            Art_freeNode(oArt, *ppsNode);
+            *ppsNode = &psNew->sInner.sNode;
+            return Art_addChild(oArt, ppsNode, ucByte, psChild);
+         }
+      }
+      case NODE16: {
+         struct artNode16 *ps = (struct artNode16 *) psInner;
+         if(ulChildren < 16) {
+            for(i = ulChildren; i > 0 && ps->aucKeys[i - 1] > ucByte; i--) {
+               ps->aucKeys[i] = ps->aucKeys[i - 1];
+               ps->apsChildren[i] = ps->apsChildren[i - 1];
+            }
+            ps->aucKeys[i] = ucByte;
+            ps->apsChildren[i] = psChild;
+            ps->sInner.usChildren++;
+            return TRUE;
+         }
+         else {
+            struct artNode48 *psNew;
+            psNew = (struct artNode48 *) Art_newInner(oArt, NODE48);
+            if(psNew == NULL)
+               return FALSE;
+            Art_copyHeader(&psNew->sInner, psInner);
+            for(i = 0; i < 16; i++) {
+               psNew->aucIndex[ps->aucKeys[i]] = (unsigned char) (i + 1);
+               psNew->apsChildren[i] = ps->apsChildren[i];
+            }
+            Art_freeNode(oArt, *ppsNode);
+            *ppsNode = &psNew->sInner.sNode;
+            return Art_addChild(oArt, ppsNode, ucByte, psChild);
+         }
+      }
+      case NODE48: {
+         struct artNode48 *ps = (struct artNode48 *) psInner;
+         if(ulChildren < 48) {
+            for(i = 0; ps->apsChildren[i] != NULL; i++)
+               ;
+            ps->apsChildren[i] = psChild;
+            ps->aucIndex[ucByte] = (unsigned char) (i + 1);
+            ps->sInner.usChildren++;
+            return TRUE;
+         }
+         else {
+            struct artNode256 *psNew;
+            psNew = (struct artNode256 *) Art_newInner(oArt, NODE256);
+            if(psNew == NULL)
+               return FALSE;
+            Art_copyHeader(&psNew->sInner, psInner);
+            for(i = 0; i < 256; i++)
+               if(ps->aucIndex[i] != 0)
+                  psNew->apsChildren[i] =
+                     ps->apsChildren[ps->aucIndex[i] - 1];
+            Art_freeNode(oArt, *ppsNode);
+            *ppsNode = &psNew->sInner.sNode;
+            return Art_addChild(oArt, ppsNode, ucByte, psChild);
+         }
+      }
+      default: {
+         struct artNode256 *ps = (struct artNode256 *) psInner;
+         ps->apsChildren[ucByte] = psChild;
+         ps->sInner.usChildren++;
+         return TRUE;
+      }
+   }
+}
+
+/* Inserts psLeaf, whose key is not yet present, into the subtree in
+   *ppsNode, whose nodes all share the first ulDepth bytes of its key.
+   Returns TRUE if successful, or FALSE, leaving the subtree as it
+   was, if memory could not be allocated. */
+static boolean Art_insert(Art_T oArt, struct artNode **ppsNode,
+                          struct artLeaf *psLeaf, size_t ulDepth) {
+   const char *pcKey = psLeaf->pcKey;
+   size_t ulLength = psLeaf->ulLength;
+   struct artInner *psInner;
+   struct artNode **ppsChild;
+
+   for(;;) {
+      struct artInner *psSplit;
+      size_t ulMatched;
+
+      if(*ppsNode == NULL) {
+         *ppsNode = &psLeaf->sNode;
+         return TRUE;
+      }
+
+      if((*ppsNode)->ucType == LEAF) {
+         /* two keys below here now: branch where they first differ */
+         struct artLeaf *psOld = (struct artLeaf *) *ppsNode;
+
+         assert(!Art_leafMatches(psOld, pcKey, ulLength));
+         for(ulMatched = 0;
+             Art_keyByte(psOld->pcKey, psOld->ulLength,
+                         ulDepth + ulMatched) ==
+             Art_keyByte(pcKey, ulLength, ulDepth + ulMatched);
+             ulMatched++)
+            ;
+         psSplit = Art_newInner(oArt, NODE4);
+         if(psSplit == NULL)
+            return FALSE;
+         Art_setPrefix(psSplit, pcKey, ulLength, ulDepth, ulMatched);
+         *ppsNode = &psSplit->sNode;
+         (void) Art_addChild(oArt, ppsNode,
+                             Art_keyByte(psOld->pcKey, psOld->ulLength,
+                                         ulDepth + ulMatched),
+                             &psOld->sNode);
+         (void) Art_addChild(oArt, ppsNode,
+                             Art_keyByte(pcKey, ulLength,
+                                         ulDepth + ulMatched),
+                             &psLeaf->sNode);
+         return TRUE;
+      }
+
+      psInner = (struct artInner *) *ppsNode;
+      if(psInner->ulPrefixLength != 0) {
+         ulMatched = Art_prefixMismatch(psInner, pcKey, ulLength, ulDepth);
+         if(ulMatched < psInner->ulPrefixLength) {
+            /* the key leaves the compressed path: split it there */
+            unsigned char ucOldByte;
+
+            psSplit = Art_newInner(oArt, NODE4);
+            if(psSplit == NULL)
+               return FALSE;
+            psSplit->ulPrefixLength = ulMatched;
+            memcpy(psSplit->aucPrefix, psInner->aucPrefix,
+                   ulMatched < MAX_PREFIX ? ulMatched : MAX_PREFIX);
+
+            if(psInner->ulPrefixLength <= MAX_PREFIX) {
+               ucOldByte = psInner->aucPrefix[ulMatched];
+               psInner->ulPrefixLength -= ulMatched + 1;
+               memmove(psInner->aucPrefix,
+                       psInner->aucPrefix + ulMatched + 1,
+                       psInner->ulPrefixLength);
+            }
+            else {
+               struct artLeaf *psMin = Art_minimum(&psInner->sNode);
+               ucOldByte = Art_keyByte(psMin->pcKey, psMin->ulLength,
+                                       ulDepth + ulMatched);
+               Art_setPrefix(psInner, psMin->pcKey, psMin->ulLength,
+                             ulDepth + ulMatched + 1,
+                             psInner->ulPrefixLength - ulMatched - 1);
+            }
+
+            *ppsNode = &psSplit->sNode;
+            (void) Art_addChild(oArt, ppsNode, ucOldByte,
+                                &psInner->sNode);
+            (void) Art_addChild(oArt, ppsNode,
+                                Art_keyByte(pcKey, ulLength,
+                                            ulDepth + ulMatched),
+                                &psLeaf->sNode);
+            return TRUE;
+         }
+         ulDepth += psInner->ulPrefixLength;
+      }
+
+      ppsChild = Art_findChild(psInner, Art_keyByte(pcKey, ulLength,
+                                                    ulDepth));
+      if(ppsChild == NULL)
+         return Art_addChild(oArt, ppsNode,
+                             Art_keyByte(pcKey, ulLength, ulDepth),
+                             &psLeaf->sNode);
+      ppsNode = ppsChild;
+      ulDepth++;
+   }
+}
+
+/* Replaces the inner node in *ppsNode, which has just lost a child,
+   by a smaller kind if its fanout has fallen far enough, or by its
+   only child if it has one left. If a smaller node cannot be
+   allocated the node is left as it is, which is still valid. */
+static void Art_shrink(Art_T oArt, struct artNode **ppsNode) {
+   struct artInner *psInner = (struct artInner *) *ppsNode;
+   struct artInner *psNew = NULL;
+   size_t ulChildren = psInner->usChildren;
+   size_t i, j;
+
+   switch(psInner->sNode.ucType) {
+      case NODE4: {
+         struct artNode4 *ps = (struct artNode4 *) psInner;
+         struct artNode *psChild;
+
+         if(ulChildren != 1)
+            return;
+         /* fold this node's path and branch byte into its only child */
+         psChild = ps->apsChildren[0];
+         if(psChild->ucType != LEAF) {
+            struct artInner *psChildInner = (struct artInner *) psChild;
+            unsigned char aucPrefix[MAX_PREFIX];
+            size_t ulStored;
+
+            ulStored = psInner->ulPrefixLength;
+            if(ulStored > MAX_PREFIX)
+               ulStored = MAX_PREFIX;
+            memcpy(aucPrefix, psInner->aucPrefix, ulStored);
+            if(ulStored < MAX_PREFIX)
+               aucPrefix[ulStored++] = ps->aucKeys[0];
+            for(i = 0; ulStored < MAX_PREFIX &&
+                   i < psChildInner->ulPrefixLength; i++)
+               aucPrefix[ulStored++] = psChildInner->aucPrefix[i];
+            memcpy(psChildInner->aucPrefix, aucPrefix, ulStored);
+            psChildInner->ulPrefixLength += psInner->ulPrefixLength + 1;
+         }
+         *ppsNode = psChild;
+         Art_freeNode(oArt, &psInner->sNode);
+         return;
+      }
+      case NODE16: {
+         struct artNode16 *ps = (struct artNode16 *) psInner;
+         struct artNode4 *ps4;
+
+         if(ulChildren != SHRINK16)
+            return;
+         psNew = Art_newInner(oArt, NODE4);
+         if(psNew == NULL)
+            return;
+         ps4 = (struct artNode4 *) psNew;
+         memcpy(ps4->aucKeys, ps->aucKeys, ulChildren);
+         memcpy(ps4->apsChildren, ps->apsChildren,
+                ulChildren * sizeof(struct artNode *));
+         break;
+      }
+      case NODE48: {
+         struct artNode48 *ps = (struct artNode48 *) psInner;
+         struct artNode16 *ps16;
+
+         if(ulChildren != SHRINK48)
+            return;
+         psNew = Art_newInner(oArt, NODE16);
+         if(psNew == NULL)
+            return;
+         ps16 = (struct artNode16 *) psNew;
+         for(i = 0, j = 0; i < 256; i++) {
+            if(ps->aucIndex[i] != 0) {
+               ps16->aucKeys[j] = (unsigned char) i;
+               ps16->apsChildren[j++] =
+                  ps->apsChildren[ps->aucIndex[i] - 1];
+            }
+         }
+         break;
+      }
+      default: {
+         struct artNode256 *ps = (struct artNode256 *) psInner;
+         struct artNode48 *ps48;
+
+         if(ulChildren != SHRINK256)
+            return;
+         psNew = Art_newInner(oArt, NODE48);
+         if(psNew == NULL)
+            return;
+         ps48 = (struct artNode48 *) psNew;
+         for(i = 0, j = 0; i < 256; i++) {
+            if(ps->apsChildren[i] != NULL) {
+               ps48->aucIndex[i] = (unsigned char) (j + 1);
+               ps48->apsChildren[j++] = ps->apsChildren[i];
+            }
+         }
+         break;
+      }
+   }
+
+   Art_copyHeader(psNew, psInner);
+   Art_freeNode(oArt, &psInner->sNode);
+   *ppsNode = &psNew->sNode;
+}
+
+/* Removes the child in slot *ppsSlot under byte ucByte from the inner
+   node in *ppsNode, then shrinks the node if it has become sparse. */
+static void Art_removeChild(Art_T oArt, struct artNode **ppsNode,
+                            unsigned char ucByte,
+                            struct artNode **ppsSlot) {
+   struct artInner *psInner = (struct artInner *) *ppsNode;
+   size_t i;
+
+   switch(psInner->sNode.ucType) {
+      case NODE4: {
+         struct artNode4 *ps = (struct artNode4 *) psInner;
+         i = (size_t) (ppsSlot - ps->apsChildren);
+         memmove(&ps->aucKeys[i], &ps->aucKeys[i + 1],
+                 psInner->usChildren - i - 1);
+         memmove(&ps->apsChildren[i], &ps->apsChildren[i + 1],
+                 (psInner->usChildren - i - 1) * sizeof(struct artNode *));
+         break;
+      }
+      case NODE16: {
+         struct artNode16 *ps = (struct artNode16 *) psInner;
+         i = (size_t) (ppsSlot - ps->apsChildren);
+         memmove(&ps->aucKeys[i], &ps->aucKeys[i + 1],
+                 psInner->usChildren - i - 1);
+         memmove(&ps->apsChildren[i], &ps->apsChildren[i + 1],
+                 (psInner->usChildren - i - 1) * sizeof(struct artNode *));
+         break;
+      }
+      case NODE48: {
+         struct artNode48 *ps = (struct artNode48 *) psInner;
+         ps->aucIndex[ucByte] = 0;
+         *ppsSlot = NULL;
+         break;
+      }
+      default:
+         *ppsSlot = NULL;
+         break;
+   }
+   psInner->usChildren--;
+   Art_shrink(oArt, ppsNode);
+}
+
+/* Calls (*pfApply)(pvValue, pvExtra) for each value at or below
+   psNode, in the order of their keys. */
+static void Art_mapTree(struct artNode *psNode,
+                        void (*pfApply)(void *pvValue, void *pvExtra),
+                        void *pvExtra) {
+   size_t i;
+
+   switch(psNode->ucType) {
+      case NODE4: {
+         struct artNode4 *ps = (struct artNode4 *) psNode;
+         for(i = 0; i < ps->sInner.usChildren; i++)
+            Art_mapTree(ps->apsChildren[i], pfApply, pvExtra);
+         break;
+      }
+      case NODE16: {
+         struct artNode16 *ps = (struct artNode16 *) psNode;
+         for(i = 0; i < ps->sInner.usChildren; i++)
+            Art_mapTree(ps->apsChildren[i], pfApply, pvExtra);
+         break;
+      }
+      case NODE48: {
+         struct artNode48 *ps = (struct artNode48 *) psNode;
+         for(i = 0; i < 256; i++)
+            if(ps->aucIndex[i] != 0)
+               Art_mapTree(ps->apsChildren[ps->aucIndex[i] - 1],
+                           pfApply, pvExtra);
+         break;
+      }
+      case NODE256: {
+         struct artNode256 *ps = (struct artNode256 *) psNode;
+         for(i = 0; i < 256; i++)
+            if(ps->apsChildren[i] != NULL)
+               Art_mapTree(ps->apsChildren[i], pfApply, pvExtra);
+         break;
+      }
+      default:
+         (*pfApply)(((struct artLeaf *) psNode)->pvValue, pvExtra);
+         break;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+Art_T Art_new(void) {
+   return Art_newIn(NULL);
+}
+
+Art_T Art_newIn(Region_T oRegion) {
+   Art_T oArt;
+
+   oArt = Region_alloc(oRegion, sizeof(struct art));
+   if(oArt == NULL)
+      return NULL;
+   oArt->psRoot = NULL;
+   oArt->ulSize = 0;
+   oArt->ulBytes = sizeof(struct art);
+   oArt->oRegion = oRegion;
+   return oArt;
+}
+
+void Art_free(Art_T oArt) {
+   if(oArt == NULL)
+      return;
+
+   Art_freeTree(oArt, oArt->psRoot);
+   Region_release(oArt->oRegion, oArt, sizeof(struct art));
+}
+
+size_t Art_getSize(Art_T oArt) {
+   assert(oArt != NULL);
+
+   return oArt->ulSize;
+}
+
+size_t Art_getBytes(Art_T oArt) {
+   assert(oArt != NULL);
+
+   return oArt->ulBytes;
+}
+
+void *Art_get(Art_T oArt, const char *pcKey, size_t ulLength) {
+   struct artNode *psNode;
+   size_t ulDepth = 0;
+
+   assert(oArt != NULL);
+   assert(pcKey != NULL);
+
+   psNode = oArt->psRoot;
+   while(psNode != NULL) {
+      struct artInner *psInner;
+      struct artNode **ppsChild;
+
+      if(psNode->ucType == LEAF) {
+         struct artLeaf *psLeaf = (struct artLeaf *) psNode;
+         if(Art_leafMatches(psLeaf, pcKey, ulLength))
+            return psLeaf->pvValue;
+         return NULL;
+      }
+
+      /* only the stored part of a compressed path is checked here: the
+         leaf's full comparison catches any mismatch past it */
+      psInner = (struct artInner *) psNode;
+      if(psInner->ulPrefixLength != 0) {
+         size_t ulStored = psInner->ulPrefixLength;
+         size_t i;
+
+         if(ulStored > MAX_PREFIX)
+            ulStored = MAX_PREFIX;
+         for(i = 0; i < ulStored; i++)
+            if(psInner->aucPrefix[i] !=
+               Art_keyByte(pcKey, ulLength, ulDepth + i))
+               return NULL;
+         ulDepth += psInner->ulPrefixLength;
+      }
+
+      ppsChild = Art_findChild(psInner,
+                               Art_keyByte(pcKey, ulLength, ulDepth));
+      if(ppsChild == NULL)
+         return NULL;
+      psNode = *ppsChild;
+      ulDepth++;
+   }
+   return NULL;
+}
+
+boolean Art_put(Art_T oArt, const char *pcKey, size_t ulLength,
+                void *pvValue) {
+   struct artLeaf *psLeaf;
+
+   assert(oArt != NULL);
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+   assert(memchr(pcKey, '\0', ulLength) == NULL);
+   assert(Art_get(oArt, pcKey, ulLength) == NULL);
+
+   psLeaf = Region_alloc(oArt->oRegion, sizeof(struct artLeaf));
+   if(psLeaf == NULL)
+      return FALSE;
+   psLeaf->sNode.ucType = LEAF;
+   psLeaf->pcKey = pcKey;
+   psLeaf->ulLength = ulLength;
+   psLeaf->pvValue = pvValue;
+   oArt->ulBytes += sizeof(struct artLeaf);
+
+   if(!Art_insert(oArt, &oArt->psRoot, psLeaf, 0)) {
+      Art_freeNode(oArt, &psLeaf->sNode);
+      return FALSE;
+   }
+   oArt->ulSize++;
+   return TRUE;
+}
+
+void *Art_remove(Art_T oArt, const char *pcKey, size_t ulLength) {
+   struct artNode **ppsNode;
+   size_t ulDepth = 0;
+
+   assert(oArt != NULL);
+   assert(pcKey != NULL);
+
+   ppsNode = &oArt->psRoot;
+   while(*ppsNode != NULL) {
+      struct artInner *psInner;
+      struct artNode **ppsChild;
+      unsigned char ucByte;
+
+      if((*ppsNode)->ucType == LEAF) {
+         /* only the root can be a leaf reached this way */
+         struct artLeaf *psLeaf = (struct artLeaf *) *ppsNode;
+         void *pvValue;
+
+         if(!Art_leafMatches(psLeaf, pcKey, ulLength))
+            return NULL;
+         pvValue = psLeaf->pvValue;
+         *ppsNode = NULL;
+         Art_freeNode(oArt, &psLeaf->sNode);
+         oArt->ulSize--;
+         return pvValue;
+      }
+
+      psInner = (struct artInner *) *ppsNode;
+      if(psInner->ulPrefixLength != 0) {
+         if(Art_prefixMismatch(psInner, pcKey, ulLength, ulDepth) !=
+            psInner->ulPrefixLength)
+            return NULL;
+         ulDepth += psInner->ulPrefixLength;
+      }
+
+      ucByte = Art_keyByte(pcKey, ulLength, ulDepth);
+      ppsChild = Art_findChild(psInner, ucByte);
+      if(ppsChild == NULL)
+         return NULL;
+      if((*ppsChild)->ucType == LEAF) {
+         struct artLeaf *psLeaf = (struct artLeaf *) *ppsChild;
+         void *pvValue;
+
+         if(!Art_leafMatches(psLeaf, pcKey, ulLength))
+            return NULL;
+         pvValue = psLeaf->pvValue;
+         Art_removeChild(oArt, ppsNode, ucByte, ppsChild);
+         Art_freeNode(oArt, &psLeaf->sNode);
+         oArt->ulSize--;
+         return pvValue;
+      }
+      ppsNode = ppsChild;
+      ulDepth++;
+   }
+   return NULL;
+}
+
+void Art_map(Art_T oArt, void (*pfApply)(void *pvValue, void *pvExtra),
+             void *pvExtra) {
+   assert(oArt != NULL);
+   assert(pfApply != NULL);
+
+   if(oArt->psRoot != NULL)
+      Art_mapTree(oArt->psRoot, pfApply, pvExtra);
+}
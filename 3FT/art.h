@@ -0,0 +1,61 @@
+/*--------------------------------------------------------------------*/
+/* art.h                                                              */
+/* Author: Zara Hommez                                                */
+/*--------------------------------------------------------------------*/
+
+#ifndef ART_INCLUDED
+#define ART_INCLUDED
+
+#include <stddef.h>
+#include "a4def.h"
+#include "region.h"
+
+/* An Art_T is an adaptive radix tree: a map from byte-string keys to
+   values that branches on one key byte per level, with inner nodes
+   of 4, 16, 48 or 256 children that grow and shrink with their
+   fanout and a compressed path for runs without branching. A lookup
+   reads each byte of the key once and compares no strings but the
+   one it finds. Keys must not contain '\0', and are ordered as strcmp
+   would order them. */
+typedef struct art *Art_T;
+
+/* Returns a new, empty Art_T, or NULL if memory could not be
+   allocated. */
+Art_T Art_new(void);
+
+/* Does the same as Art_new, but allocates the Art_T and its nodes from
+   oRegion; Art_new is Art_newIn(NULL). */
+Art_T Art_newIn(Region_T oRegion);
+
+/* Frees oArt. Neither the keys nor the values are freed. */
+void Art_free(Art_T oArt);
+
+/* Returns the number of keys in oArt. */
+size_t Art_getSize(Art_T oArt);
+
+/* Returns the number of bytes oArt has allocated, including its
+   handle. */
+size_t Art_getBytes(Art_T oArt);
+
+/* Returns the value stored under the ulLength bytes at pcKey, which
+   need not be '\0'-terminated, or NULL if there is none. */
+void *Art_get(Art_T oArt, const char *pcKey, size_t ulLength);
+
+/* Stores non-NULL pvValue under the ulLength bytes at pcKey, which
+   must not already be in oArt. The key's bytes are borrowed rather
+   than copied, so they must stay unchanged until the key is removed.
+   Returns TRUE if successful, or FALSE, leaving oArt as it was, if
+   memory could not be allocated. */
+boolean Art_put(Art_T oArt, const char *pcKey, size_t ulLength,
+                void *pvValue);
+
+/* Removes the ulLength bytes at pcKey from oArt. Returns the value
+   that was stored under them, or NULL if the key was not in oArt. */
+void *Art_remove(Art_T oArt, const char *pcKey, size_t ulLength);
+
+/* Calls (*pfApply)(pvValue, pvExtra) for each value in oArt, in the
+   order of their keys. */
+void Art_map(Art_T oArt, void (*pfApply)(void *pvValue, void *pvExtra),
+             void *pvExtra);
+
+#endif
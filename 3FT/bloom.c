@@ -0,0 +1,148 @@
+/*--------------------------------------------------------------------*/
+/* bloom.c                                                            */
+/* Author: Zara Hommez                                                */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "bloom.h"
+
+/* The most counters a key sets, whatever false positive rate is
+   asked for */
+enum { MAX_HASHES = 16 };
+
+/* The value at which a counter sticks: it is no longer counted up or
+   down, since it may then stand for more keys than it can count */
+enum { STUCK = 255 };
+
+struct bloom {
+   /* the counters; their number is a power of 2 */
+   unsigned char *pucCounters;
+   /* the number of counters less one */
+   size_t ulMask;
+   /* the number of counters each key sets */
+   size_t ulHashes;
+   /* the number of keys the filter was sized for */
+   size_t ulCapacity;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Returns the index of the ulIth counter set by the key that hashes
+   to ullHash in oBFilter. The counters are spread by double hashing:
+   two hashes derived from ullHash are combined as h1 + i * h2. */
+static size_t Bloom_counterOf(Bloom_T oBFilter, unsigned long long ullHash,
+                              size_t ulI) {
+   unsigned long long ullStep;
+
+   assert(oBFilter != NULL);
+
+   /* an odd step visits distinct counters for every ulI < the count */
+   ullStep = ((ullHash >> 32) | (ullHash << 32)) * 0x9E3779B97F4A7C15ULL;
+   ullStep |= 1;
+   return (size_t) (ullHash + ulI * ullStep) & oBFilter->ulMask;
+}
+
+/*--------------------------------------------------------------------*/
+
+Bloom_T Bloom_new(size_t ulCapacity, double dFalsePositiveRate) {
+   Bloom_T oBFilter;
+   size_t ulHashes;
+   size_t ulCounters;
+   double dRate;
+
+   assert(dFalsePositiveRate > 0 && dFalsePositiveRate < 1);
+
+   /* with the best number of counters per key, the rate halves with
+      each further counter a key sets, and each counter a key sets
+      costs 1 / ln 2 (about 1.44) counters per key */
+   ulHashes = 1;
+   for(dRate = 0.5; dRate > dFalsePositiveRate && ulHashes < MAX_HASHES;
+       dRate /= 2)
+      ulHashes++;
+   if(ulCapacity == 0)
+      ulCapacity = 1;
+   for(ulCounters = 1;
+       (double) ulCounters < 1.4427 * (double) ulHashes *
+          (double) ulCapacity;
+       ulCounters *= 2)
+      ;
+
+   oBFilter = malloc(sizeof(struct bloom));
+   if(oBFilter == NULL)
+      return NULL;
+   oBFilter->pucCounters = calloc(ulCounters, 1);
+   if(oBFilter->pucCounters == NULL) {
+      free(oBFilter);
+      return NULL;
+   }
+   oBFilter->ulMask = ulCounters - 1;
+   oBFilter->ulHashes = ulHashes;
+   oBFilter->ulCapacity = ulCapacity;
+   return oBFilter;
+}
+
+void Bloom_free(Bloom_T oBFilter) {
+   if(oBFilter == NULL)
+      return;
+
+   free(oBFilter->pucCounters);
+   free(oBFilter);
+}
+
+void Bloom_add(Bloom_T oBFilter, unsigned long long ullHash) {
+   size_t i;
+
+   assert(oBFilter != NULL);
+
+   for(i = 0; i < oBFilter->ulHashes; i++) {
+      unsigned char *puc =
+         &oBFilter->pucCounters[Bloom_counterOf(oBFilter, ullHash, i)];
+      if(*puc != STUCK)
+         (*puc)++;
+   }
+}
+
+void Bloom_remove(Bloom_T oBFilter, unsigned long long ullHash) {
+   size_t i;
+
+   assert(oBFilter != NULL);
+
+   for(i = 0; i < oBFilter->ulHashes; i++) {
+      unsigned char *puc =
+         &oBFilter->pucCounters[Bloom_counterOf(oBFilter, ullHash, i)];
+      assert(*puc != 0);
+      if(*puc != STUCK)
+         (*puc)--;
+   }
+}
+
+boolean Bloom_mayContain(Bloom_T oBFilter, unsigned long long ullHash) {
+   size_t i;
+
+   assert(oBFilter != NULL);
+
+   for(i = 0; i < oBFilter->ulHashes; i++)
+      if(oBFilter->pucCounters[Bloom_counterOf(oBFilter, ullHash, i)] == 0)
+         return FALSE;
+   return TRUE;
+}
+
+size_t Bloom_getCapacity(Bloom_T oBFilter) {
+   assert(oBFilter != NULL);
+
+   return oBFilter->ulCapacity;
+}
+
+size_t Bloom_getHashCount(Bloom_T oBFilter) {
+   assert(oBFilter != NULL);
+
+   return oBFilter->ulHashes;
+}
+
+size_t Bloom_getBytes(Bloom_T oBFilter) {
+   assert(oBFilter != NULL);
+
+   return sizeof(struct bloom) + oBFilter->ulMask + 1;
+}
@@ -0,0 +1,54 @@
+/*--------------------------------------------------------------------*/
+/* bloom.h                                                            */
+/* Author: Zara Hommez                                                */
+/*--------------------------------------------------------------------*/
+
+#ifndef BLOOM_INCLUDED
+#define BLOOM_INCLUDED
+
+/*
+  A Bloom_T is a counting Bloom filter over 64-bit key hashes: it can
+  say for certain that a key was never added (or has been removed as
+  often as it was added), and otherwise says only that it may have
+  been. Each key sets several small counters rather than bits, so keys
+  can be removed as well as added.
+*/
+
+#include <stddef.h>
+#include "a4def.h"
+
+typedef struct bloom *Bloom_T;
+
+/*
+  Returns a new, empty Bloom_T sized so that with up to ulCapacity keys
+  in it, a key that is not in it is reported as possibly present at
+  most a fraction dFalsePositiveRate of the time, which must be
+  between 0 and 1 exclusive. Returns NULL if memory could not be
+  allocated.
+*/
+Bloom_T Bloom_new(size_t ulCapacity, double dFalsePositiveRate);
+
+/* Frees oBFilter. */
+void Bloom_free(Bloom_T oBFilter);
+
+/* Adds the key that hashes to ullHash to oBFilter. */
+void Bloom_add(Bloom_T oBFilter, unsigned long long ullHash);
+
+/* Removes the key that hashes to ullHash, which must have been added
+   more times than it has been removed, from oBFilter. */
+void Bloom_remove(Bloom_T oBFilter, unsigned long long ullHash);
+
+/* Returns FALSE if the key that hashes to ullHash is certainly not in
+   oBFilter, and TRUE if it may be. */
+boolean Bloom_mayContain(Bloom_T oBFilter, unsigned long long ullHash);
+
+/* Returns the number of keys oBFilter was sized for. */
+size_t Bloom_getCapacity(Bloom_T oBFilter);
+
+/* Returns the number of counters each key sets in oBFilter. */
+size_t Bloom_getHashCount(Bloom_T oBFilter);
+
+/* Returns the bytes oBFilter has allocated, including its handle. */
+size_t Bloom_getBytes(Bloom_T oBFilter);
+
+#endif
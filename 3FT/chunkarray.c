@@ -0,0 +1,831 @@
+/*--------------------------------------------------------------------*/
+/* chunkarray.c                                                       */
+/* Author: Zara Hommez                                                */
+/*--------------------------------------------------------------------*/
+
+#include "chunkarray.h"
+#include "region.h"
+#include "slab.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The most elements a chunk of a new array holds; a full chunk is
+   split in two before anything more is added to it. The limit
+   doubles whenever its square falls short of the array's length, so
+   that an array of k elements has O(sqrt k) chunks, each of O(sqrt k)
+   elements. */
+
+enum { MIN_CHUNK_LIMIT = 512 };
+
+/* The physical length of a newly allocated chunk. A chunk grows by
+   doubling up to its array's limit, so a small array stays small. */
+
+enum { MIN_CHUNK_PHYS_LENGTH = 4 };
+
+/*--------------------------------------------------------------------*/
+
+/* A Chunk is one run of consecutive elements, stored in the same
+   allocation as its header. */
+
+struct Chunk
+{
+   /* The number of elements in the chunk. */
+   size_t uLength;
+
+   /* The number of elements the chunk has room for. */
+   size_t uPhysLength;
+
+   /* The chunk's position in its array's list of chunks. */
+   size_t uPos;
+
+   /* The elements. */
+   const void *ppvElements[];
+};
+
+/* A ChunkArray is a list of non-empty chunks, along with the index
+   (within the whole array) of each chunk's first element and a
+   cursor remembering the chunk most recently located.  The indexes
+   are brought up to date lazily, when one is next needed, so that
+   removing an element found through its chunk costs nothing per
+   chunk. */
+
+struct ChunkArray
+{
+   /* The number of elements in the ChunkArray from the client's
+      point of view. */
+   size_t uLength;
+
+   /* The number of chunks in use. */
+   size_t uChunks;
+
+   /* The number of chunks ppsChunks and puStarts have room for. */
+   size_t uPhysChunks;
+
+   /* The most elements a chunk may hold: MIN_CHUNK_LIMIT, doubled
+      as the array grows, and never lowered. */
+   size_t uChunkLimit;
+
+   /* The chunks, in order. */
+   struct Chunk **ppsChunks;
+
+   /* The first chunk, the same as ppsChunks[0], kept here so that a
+      small array, which is a single chunk, is reached in one step as
+      a DynArray's elements would be. */
+   struct Chunk *psFirst;
+
+   /* puStarts[i] is the index of the first element of chunk i, for
+      each i less than uValidStarts; the rest are out of date. */
+   size_t *puStarts;
+
+   /* The number of leading entries of puStarts that are up to
+      date. */
+   size_t uValidStarts;
+
+   /* puLengths[i] is the length of chunk i, kept beside puStarts, in
+      the same allocation, so that the starts are brought up to date
+      without visiting the chunks. */
+   size_t *puLengths;
+
+   /* The chunk most recently located; less than uChunks unless
+      uChunks is 0. */
+   size_t uCursor;
+
+   /* The region the header, chunks and chunk list are allocated
+      from, or NULL if they come from the slab and malloc. */
+   Region_T oRegion;
+
+   /* The function told of each element's chunk whenever that changes,
+      or NULL; see ChunkArray_setTracker. */
+   void (*pfMoved)(void *pvElement, void *pvChunk);
+};
+
+/* The slab every ChunkArray header comes from, made with the first
+   header after ChunkArray_freeSlab, or ever, and freed with its pages
+   by the next ChunkArray_freeSlab. */
+
+static Slab_T oSHeaders;
+
+/*--------------------------------------------------------------------*/
+
+#ifdef CHUNKARRAY_CHECK_ALL
+
+/* Check the invariants of oChunkArray.  Return 1 (TRUE) iff
+   oChunkArray is in a valid state.  This visits every chunk, so it is
+   only called, on entry to and exit from each function that changes
+   or searches the array, when CHUNKARRAY_CHECK_ALL is defined. */
+
+static int ChunkArray_isValid(ChunkArray_T oChunkArray)
+{
+   size_t uChunk;
+   size_t uStart = 0;
+
+   if (oChunkArray->uChunks > oChunkArray->uPhysChunks) return 0;
+   if (oChunkArray->uChunks != 0 &&
+       oChunkArray->uCursor >= oChunkArray->uChunks) return 0;
+   if (oChunkArray->uChunks != 0 &&
+       oChunkArray->psFirst != oChunkArray->ppsChunks[0]) return 0;
+   if (oChunkArray->uValidStarts > oChunkArray->uChunks) return 0;
+   for (uChunk = 0; uChunk < oChunkArray->uChunks; uChunk++)
+   {
+      struct Chunk *psChunk = oChunkArray->ppsChunks[uChunk];
+      if (psChunk->uLength == 0) return 0;
+      if (psChunk->uLength > psChunk->uPhysLength) return 0;
+      if (psChunk->uPhysLength > oChunkArray->uChunkLimit) return 0;
+      if (psChunk->uPos != uChunk) return 0;
+      if (oChunkArray->puLengths[uChunk] != psChunk->uLength) return 0;
+      if (uChunk < oChunkArray->uValidStarts &&
+          oChunkArray->puStarts[uChunk] != uStart) return 0;
+      uStart += psChunk->uLength;
+   }
+   if (uStart != oChunkArray->uLength) return 0;
+   return 1;
+}
+
+#define ChunkArray_check(oChunkArray) \
+   assert(ChunkArray_isValid(oChunkArray))
+
+#else
+#define ChunkArray_check(oChunkArray) ((void) 0)
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Return the size of a chunk with room for uPhysLength elements. */
+
+static size_t ChunkArray_chunkSize(size_t uPhysLength)
+{
+   return sizeof(struct Chunk) + uPhysLength * sizeof(const void *);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new chunk for oChunkArray with room for uPhysLength
+   elements, or NULL if insufficient memory is available. */
+
+static struct Chunk *ChunkArray_newChunk(ChunkArray_T oChunkArray,
+                                         size_t uPhysLength)
+{
+   struct Chunk *psChunk;
+
+   assert(oChunkArray != NULL);
+
+   psChunk = Region_alloc(oChunkArray->oRegion,
+                          ChunkArray_chunkSize(uPhysLength));
+   if (psChunk == NULL)
+      return NULL;
+   psChunk->uLength = 0;
+   psChunk->uPhysLength = uPhysLength;
+   return psChunk;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free psChunk, one of oChunkArray's chunks. */
+
+static void ChunkArray_freeChunk(ChunkArray_T oChunkArray,
+                                 struct Chunk *psChunk)
+{
+   assert(oChunkArray != NULL);
+   assert(psChunk != NULL);
+
+   Region_release(oChunkArray->oRegion, psChunk,
+                  ChunkArray_chunkSize(psChunk->uPhysLength));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Tell oChunkArray's tracker, if it has one, that the uCount elements
+   of psChunk from offset uOffset on are now in psChunk. */
+
+static void ChunkArray_track(ChunkArray_T oChunkArray,
+                             struct Chunk *psChunk, size_t uOffset,
+                             size_t uCount)
+{
+   size_t u;
+
+   assert(oChunkArray != NULL);
+   assert(psChunk != NULL);
+
+   if (oChunkArray->pfMoved == NULL)
+      return;
+   for (u = uOffset; u < uOffset + uCount; u++)
+      (*oChunkArray->pfMoved)((void *) psChunk->ppvElements[u], psChunk);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Set the position of each of oChunkArray's chunks from position
+   uChunk on to its place in the list. */
+
+static void ChunkArray_renumber(ChunkArray_T oChunkArray, size_t uChunk)
+{
+   size_t u;
+
+   assert(oChunkArray != NULL);
+
+   for (u = uChunk; u < oChunkArray->uChunks; u++)
+      oChunkArray->ppsChunks[u]->uPos = u;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Set the length of psChunk, one of oChunkArray's chunks, to
+   uLength. */
+
+static void ChunkArray_setLength(ChunkArray_T oChunkArray,
+                                 struct Chunk *psChunk, size_t uLength)
+{
+   assert(oChunkArray != NULL);
+   assert(psChunk != NULL);
+
+   psChunk->uLength = uLength;
+   oChunkArray->puLengths[psChunk->uPos] = uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Note that the start index of every chunk after position uChunk may
+   now be out of date. */
+
+static void ChunkArray_staleStarts(ChunkArray_T oChunkArray,
+                                   size_t uChunk)
+{
+   assert(oChunkArray != NULL);
+
+   if (oChunkArray->uValidStarts > uChunk + 1)
+      oChunkArray->uValidStarts = uChunk + 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Bring the start indexes of oChunkArray's chunks up to position
+   uChunk up to date. */
+
+static void ChunkArray_fixStarts(ChunkArray_T oChunkArray, size_t uChunk)
+{
+   size_t u;
+
+   assert(oChunkArray != NULL);
+   assert(uChunk < oChunkArray->uChunks);
+
+   u = oChunkArray->uValidStarts;
+   if (u > uChunk)
+      return;
+   if (u == 0)
+   {
+      oChunkArray->puStarts[0] = 0;
+      u = 1;
+   }
+   for (; u <= uChunk; u++)
+      oChunkArray->puStarts[u] = oChunkArray->puStarts[u - 1] +
+         oChunkArray->puLengths[u - 1];
+   oChunkArray->uValidStarts = uChunk + 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Insert psChunk into oChunkArray's list of chunks at position
+   uChunk.  Return 1 (TRUE) if successful, or 0 (FALSE) if
+   insufficient memory is available. */
+
+static int ChunkArray_insertChunk(ChunkArray_T oChunkArray,
+                                  size_t uChunk, struct Chunk *psChunk)
+{
+   assert(oChunkArray != NULL);
+   assert(uChunk <= oChunkArray->uChunks);
+   assert(psChunk != NULL);
+
+   if (oChunkArray->uChunks == oChunkArray->uPhysChunks)
+   {
+      size_t uNewPhys = 2 * oChunkArray->uPhysChunks;
+      struct Chunk **ppsNewChunks;
+      size_t *puNewStarts;
+
+      if (uNewPhys == 0)
+         uNewPhys = 1;
+      ppsNewChunks = Region_alloc(oChunkArray->oRegion,
+                                  uNewPhys * sizeof(struct Chunk *));
+      if (ppsNewChunks == NULL)
+         return 0;
+      puNewStarts = Region_alloc(oChunkArray->oRegion,
+                                 2 * uNewPhys * sizeof(size_t));
+      if (puNewStarts == NULL)
+      {
+         Region_release(oChunkArray->oRegion, ppsNewChunks,
+                        uNewPhys * sizeof(struct Chunk *));
+         return 0;
+      }
+      if (oChunkArray->uChunks != 0)
+      {
+         memcpy(ppsNewChunks, oChunkArray->ppsChunks,
+                oChunkArray->uChunks * sizeof(struct Chunk *));
+         memcpy(puNewStarts, oChunkArray->puStarts,
+                oChunkArray->uValidStarts * sizeof(size_t));
+         memcpy(puNewStarts + uNewPhys, oChunkArray->puLengths,
+                oChunkArray->uChunks * sizeof(size_t));
+      }
+      Region_release(oChunkArray->oRegion, oChunkArray->ppsChunks,
+                     oChunkArray->uPhysChunks * sizeof(struct Chunk *));
+      Region_release(oChunkArray->oRegion, oChunkArray->puStarts,
+                     2 * oChunkArray->uPhysChunks * sizeof(size_t));
+      oChunkArray->ppsChunks = ppsNewChunks;
+      oChunkArray->puStarts = puNewStarts;
+      oChunkArray->puLengths = puNewStarts + uNewPhys;
+      oChunkArray->uPhysChunks = uNewPhys;
+   }
+
+   memmove(&oChunkArray->ppsChunks[uChunk + 1],
+           &oChunkArray->ppsChunks[uChunk],
+           (oChunkArray->uChunks - uChunk) * sizeof(struct Chunk *));
+   memmove(&oChunkArray->puLengths[uChunk + 1],
+           &oChunkArray->puLengths[uChunk],
+           (oChunkArray->uChunks - uChunk) * sizeof(size_t));
+   oChunkArray->ppsChunks[uChunk] = psChunk;
+   oChunkArray->puLengths[uChunk] = psChunk->uLength;
+   oChunkArray->uChunks++;
+   oChunkArray->psFirst = oChunkArray->ppsChunks[0];
+   ChunkArray_renumber(oChunkArray, uChunk);
+   if (oChunkArray->uValidStarts > uChunk)
+      oChunkArray->uValidStarts = uChunk;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the chunk at position uChunk from oChunkArray's list of
+   chunks, without freeing it. */
+
+static void ChunkArray_removeChunk(ChunkArray_T oChunkArray,
+                                   size_t uChunk)
+{
+   assert(oChunkArray != NULL);
+   assert(uChunk < oChunkArray->uChunks);
+
+   memmove(&oChunkArray->ppsChunks[uChunk],
+           &oChunkArray->ppsChunks[uChunk + 1],
+           (oChunkArray->uChunks - uChunk - 1) * sizeof(struct Chunk *));
+   memmove(&oChunkArray->puLengths[uChunk],
+           &oChunkArray->puLengths[uChunk + 1],
+           (oChunkArray->uChunks - uChunk - 1) * sizeof(size_t));
+   oChunkArray->uChunks--;
+   ChunkArray_renumber(oChunkArray, uChunk);
+   if (oChunkArray->uValidStarts > uChunk)
+      oChunkArray->uValidStarts = uChunk;
+   if (oChunkArray->uChunks != 0)
+      oChunkArray->psFirst = oChunkArray->ppsChunks[0];
+   if (oChunkArray->uCursor >= oChunkArray->uChunks &&
+       oChunkArray->uCursor > 0)
+      oChunkArray->uCursor = oChunkArray->uChunks - 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the position of the chunk holding the uIndex'th element of
+   oChunkArray, and make it the cursor.  The cursor's chunk and the
+   one after it are tried first, so walking the array in order costs
+   constant time per element. */
+
+static size_t ChunkArray_locate(ChunkArray_T oChunkArray, size_t uIndex)
+{
+   size_t uCursor, uLo, uHi;
+
+   assert(oChunkArray != NULL);
+   assert(uIndex < oChunkArray->uLength);
+
+   ChunkArray_fixStarts(oChunkArray, oChunkArray->uChunks - 1);
+   uCursor = oChunkArray->uCursor;
+   if (uIndex >= oChunkArray->puStarts[uCursor])
+   {
+      if (uIndex - oChunkArray->puStarts[uCursor] <
+          oChunkArray->puLengths[uCursor])
+         return uCursor;
+      if (uCursor + 1 < oChunkArray->uChunks &&
+          uIndex - oChunkArray->puStarts[uCursor + 1] <
+          oChunkArray->puLengths[uCursor + 1])
+      {
+         oChunkArray->uCursor = uCursor + 1;
+         return uCursor + 1;
+      }
+   }
+
+   /* the last chunk starting at or before uIndex */
+   uLo = 0;
+   uHi = oChunkArray->uChunks - 1;
+   while (uLo < uHi)
+   {
+      size_t uMid = uLo + (uHi - uLo + 1) / 2;
+      if (oChunkArray->puStarts[uMid] <= uIndex)
+         uLo = uMid;
+      else
+         uHi = uMid - 1;
+   }
+   oChunkArray->uCursor = uLo;
+   return uLo;
+}
+
+/*--------------------------------------------------------------------*/
+
+ChunkArray_T ChunkArray_new(void)
+{
+   return ChunkArray_newIn(NULL);
+}
+
+/*--------------------------------------------------------------------*/
+
+ChunkArray_T ChunkArray_newIn(Region_T oRegion)
+{
+   ChunkArray_T oChunkArray;
+
+   if (oRegion != NULL)
+      oChunkArray = Region_alloc(oRegion, sizeof(struct ChunkArray));
+   else
+   {
+      if (oSHeaders == NULL)
+      {
+         oSHeaders = Slab_new(sizeof(struct ChunkArray));
+         if (oSHeaders == NULL)
+            return NULL;
+      }
+      oChunkArray = Slab_alloc(oSHeaders);
+   }
+   if (oChunkArray == NULL)
+      return NULL;
+
+   /* the chunk list is allocated when the first element is added */
+   oChunkArray->uLength = 0;
+   oChunkArray->uChunks = 0;
+   oChunkArray->uPhysChunks = 0;
+   oChunkArray->uChunkLimit = MIN_CHUNK_LIMIT;
+   oChunkArray->ppsChunks = NULL;
+   oChunkArray->psFirst = NULL;
+   oChunkArray->puStarts = NULL;
+   oChunkArray->uValidStarts = 0;
+   oChunkArray->puLengths = NULL;
+   oChunkArray->uCursor = 0;
+   oChunkArray->oRegion = oRegion;
+   oChunkArray->pfMoved = NULL;
+   return oChunkArray;
+}
+
+/*--------------------------------------------------------------------*/
+
+void ChunkArray_free(ChunkArray_T oChunkArray)
+{
+   size_t uChunk;
+   Region_T oRegion;
+
+   if (oChunkArray == NULL)
+      return;
+
+   oRegion = oChunkArray->oRegion;
+   for (uChunk = 0; uChunk < oChunkArray->uChunks; uChunk++)
+      ChunkArray_freeChunk(oChunkArray, oChunkArray->ppsChunks[uChunk]);
+   Region_release(oRegion, oChunkArray->ppsChunks,
+                  oChunkArray->uPhysChunks * sizeof(struct Chunk *));
+   Region_release(oRegion, oChunkArray->puStarts,
+                  2 * oChunkArray->uPhysChunks * sizeof(size_t));
+   if (oRegion != NULL)
+      Region_release(oRegion, oChunkArray, sizeof(struct ChunkArray));
+   else
+      Slab_release(oSHeaders, oChunkArray);
+}
+
+/*--------------------------------------------------------------------*/
+
+void ChunkArray_setTracker(ChunkArray_T oChunkArray,
+                           void (*pfMoved)(void *pvElement,
+                                           void *pvChunk))
+{
+   assert(oChunkArray != NULL);
+   assert(oChunkArray->uLength == 0);
+
+   oChunkArray->pfMoved = pfMoved;
+}
+
+/*--------------------------------------------------------------------*/
+
+void ChunkArray_getSlabStats(struct Slab_Stats *psStats)
+{
+   assert(psStats != NULL);
+
+   Slab_getStats(oSHeaders, psStats);
+}
+
+/*--------------------------------------------------------------------*/
+
+void ChunkArray_freeSlab(void)
+{
+   struct Slab_Stats sStats;
+
+   Slab_getStats(oSHeaders, &sStats);
+   if (sStats.ulLive != 0)
+      return;
+   Slab_free(oSHeaders);
+   oSHeaders = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t ChunkArray_getLength(ChunkArray_T oChunkArray)
+{
+   assert(oChunkArray != NULL);
+
+   return oChunkArray->uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *ChunkArray_get(ChunkArray_T oChunkArray, size_t uIndex)
+{
+   size_t uChunk;
+
+   assert(oChunkArray != NULL);
+   assert(uIndex < oChunkArray->uLength);
+   ChunkArray_check(oChunkArray);
+
+   /* a small array is a single chunk */
+   if (oChunkArray->uChunks == 1)
+      return (void *) oChunkArray->psFirst->ppvElements[uIndex];
+
+   uChunk = ChunkArray_locate(oChunkArray, uIndex);
+   return (void *) oChunkArray->ppsChunks[uChunk]->ppvElements[
+      uIndex - oChunkArray->puStarts[uChunk]];
+}
+
+/*--------------------------------------------------------------------*/
+
+int ChunkArray_addAt(ChunkArray_T oChunkArray, size_t uIndex,
+                     const void *pvElement)
+{
+   size_t uChunk, uOffset;
+   struct Chunk *psChunk;
+
+   assert(oChunkArray != NULL);
+   assert(uIndex <= oChunkArray->uLength);
+   ChunkArray_check(oChunkArray);
+
+   /* find the chunk to add to: an index just past the end goes at
+      the end of the last chunk */
+   if (oChunkArray->uChunks == 0)
+   {
+      psChunk = ChunkArray_newChunk(oChunkArray, MIN_CHUNK_PHYS_LENGTH);
+      if (psChunk == NULL)
+         return 0;
+      if (!ChunkArray_insertChunk(oChunkArray, 0, psChunk))
+      {
+         ChunkArray_freeChunk(oChunkArray, psChunk);
+         return 0;
+      }
+      uChunk = 0;
+   }
+   else if (uIndex == oChunkArray->uLength)
+      uChunk = oChunkArray->uChunks - 1;
+   else
+      uChunk = ChunkArray_locate(oChunkArray, uIndex);
+   ChunkArray_fixStarts(oChunkArray, uChunk);
+   psChunk = oChunkArray->ppsChunks[uChunk];
+   uOffset = uIndex - oChunkArray->puStarts[uChunk];
+
+   /* keep the limit at least the square root of the length, so that
+      neither the chunks nor the list of them grow past O(sqrt k) */
+   if (oChunkArray->uLength / oChunkArray->uChunkLimit >=
+       oChunkArray->uChunkLimit)
+      oChunkArray->uChunkLimit *= 2;
+
+   /* a full chunk is split in half first */
+   if (psChunk->uLength == oChunkArray->uChunkLimit)
+   {
+      struct Chunk *psUpper;
+      size_t uLimit = oChunkArray->uChunkLimit;
+      size_t uHalf = uLimit / 2;
+
+      psUpper = ChunkArray_newChunk(oChunkArray, uLimit);
+      if (psUpper == NULL)
+         return 0;
+      if (!ChunkArray_insertChunk(oChunkArray, uChunk + 1, psUpper))
+      {
+         ChunkArray_freeChunk(oChunkArray, psUpper);
+         return 0;
+      }
+      memcpy(psUpper->ppvElements, &psChunk->ppvElements[uHalf],
+             (uLimit - uHalf) * sizeof(const void *));
+      ChunkArray_setLength(oChunkArray, psUpper, uLimit - uHalf);
+      ChunkArray_setLength(oChunkArray, psChunk, uHalf);
+      ChunkArray_track(oChunkArray, psUpper, 0, psUpper->uLength);
+
+      if (uOffset > uHalf)
+      {
+         uChunk++;
+         uOffset -= uHalf;
+         psChunk = psUpper;
+      }
+   }
+   /* otherwise a chunk that is not yet full size may need to grow */
+   else if (psChunk->uLength == psChunk->uPhysLength)
+   {
+      size_t uNewPhys = 2 * psChunk->uPhysLength;
+      struct Chunk *psGrown;
+
+      if (uNewPhys > oChunkArray->uChunkLimit)
+         uNewPhys = oChunkArray->uChunkLimit;
+      psGrown = Region_resize(oChunkArray->oRegion, psChunk,
+                              ChunkArray_chunkSize(psChunk->uPhysLength),
+                              ChunkArray_chunkSize(uNewPhys));
+      if (psGrown == NULL)
+         return 0;
+      psGrown->uPhysLength = uNewPhys;
+      if (psGrown != psChunk)
+         ChunkArray_track(oChunkArray, psGrown, 0, psGrown->uLength);
+      oChunkArray->ppsChunks[uChunk] = psChunk = psGrown;
+      if (uChunk == 0)
+         oChunkArray->psFirst = psGrown;
+   }
+
+   memmove(&psChunk->ppvElements[uOffset + 1],
+           &psChunk->ppvElements[uOffset],
+           (psChunk->uLength - uOffset) * sizeof(const void *));
+   psChunk->ppvElements[uOffset] = pvElement;
+   ChunkArray_setLength(oChunkArray, psChunk, psChunk->uLength + 1);
+   ChunkArray_track(oChunkArray, psChunk, uOffset, 1);
+   ChunkArray_staleStarts(oChunkArray, uChunk);
+   oChunkArray->uLength++;
+   oChunkArray->uCursor = uChunk;
+
+   ChunkArray_check(oChunkArray);
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove and return the element at offset uOffset of the chunk at
+   position uChunk of oChunkArray. */
+
+static void *ChunkArray_removeFrom(ChunkArray_T oChunkArray,
+                                   size_t uChunk, size_t uOffset)
+{
+   struct Chunk *psChunk;
+   const void *pvOldElement;
+
+   assert(oChunkArray != NULL);
+   assert(uChunk < oChunkArray->uChunks);
+
+   psChunk = oChunkArray->ppsChunks[uChunk];
+   assert(uOffset < psChunk->uLength);
+
+   pvOldElement = psChunk->ppvElements[uOffset];
+   memmove(&psChunk->ppvElements[uOffset],
+           &psChunk->ppvElements[uOffset + 1],
+           (psChunk->uLength - uOffset - 1) * sizeof(const void *));
+   ChunkArray_setLength(oChunkArray, psChunk, psChunk->uLength - 1);
+   ChunkArray_staleStarts(oChunkArray, uChunk);
+   oChunkArray->uLength--;
+
+   if (psChunk->uLength == 0)
+   {
+      ChunkArray_removeChunk(oChunkArray, uChunk);
+      ChunkArray_freeChunk(oChunkArray, psChunk);
+   }
+   /* merge a chunk with its successor once both are at most a quarter
+      full, so the number of chunks stays proportional to the length */
+   else if (uChunk + 1 < oChunkArray->uChunks &&
+            psChunk->uLength + oChunkArray->puLengths[uChunk + 1] <=
+            oChunkArray->uChunkLimit / 2 &&
+            psChunk->uLength + oChunkArray->puLengths[uChunk + 1] <=
+            psChunk->uPhysLength)
+   {
+      struct Chunk *psNext = oChunkArray->ppsChunks[uChunk + 1];
+
+      memcpy(&psChunk->ppvElements[psChunk->uLength],
+             psNext->ppvElements,
+             psNext->uLength * sizeof(const void *));
+      ChunkArray_track(oChunkArray, psChunk, psChunk->uLength,
+                       psNext->uLength);
+      ChunkArray_setLength(oChunkArray, psChunk,
+                           psChunk->uLength + psNext->uLength);
+      ChunkArray_removeChunk(oChunkArray, uChunk + 1);
+      ChunkArray_freeChunk(oChunkArray, psNext);
+   }
+
+   ChunkArray_check(oChunkArray);
+   return (void *) pvOldElement;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *ChunkArray_removeAt(ChunkArray_T oChunkArray, size_t uIndex)
+{
+   size_t uChunk;
+
+   assert(oChunkArray != NULL);
+   assert(uIndex < oChunkArray->uLength);
+   ChunkArray_check(oChunkArray);
+
+   uChunk = ChunkArray_locate(oChunkArray, uIndex);
+   return ChunkArray_removeFrom(oChunkArray, uChunk,
+                                uIndex - oChunkArray->puStarts[uChunk]);
+}
+
+/*--------------------------------------------------------------------*/
+
+void ChunkArray_removeElement(ChunkArray_T oChunkArray, void *pvChunk,
+                              const void *pvElement)
+{
+   struct Chunk *psChunk = pvChunk;
+   size_t uOffset;
+
+   assert(oChunkArray != NULL);
+   assert(oChunkArray->pfMoved != NULL);
+   assert(psChunk != NULL);
+   assert(psChunk->uPos < oChunkArray->uChunks);
+   assert(oChunkArray->ppsChunks[psChunk->uPos] == psChunk);
+   ChunkArray_check(oChunkArray);
+
+   /* no index is needed, so none of the start indexes are */
+   for (uOffset = 0; psChunk->ppvElements[uOffset] != pvElement;
+        uOffset++)
+      assert(uOffset + 1 < psChunk->uLength);
+
+   oChunkArray->uCursor = psChunk->uPos;
+   (void) ChunkArray_removeFrom(oChunkArray, psChunk->uPos, uOffset);
+}
+
+/*--------------------------------------------------------------------*/
+
+int ChunkArray_bsearch(ChunkArray_T oChunkArray,
+                       void *pvSoughtElement,
+                       size_t *puIndex,
+                       int (*pfCompare)(const void *pvElement1,
+                                        const void *pvElement2))
+{
+   size_t uLo, uHi, uChunk, uStart;
+   struct Chunk *psChunk;
+   int iCompare;
+
+   assert(oChunkArray != NULL);
+   assert(puIndex != NULL);
+   assert(pfCompare != NULL);
+   ChunkArray_check(oChunkArray);
+
+   if (oChunkArray->uLength == 0)
+   {
+      *puIndex = 0;
+      return 0;
+   }
+
+   /* the last chunk whose first element is not greater than the
+      sought one, or the first chunk if there is none */
+   uChunk = 0;
+   psChunk = oChunkArray->psFirst;
+   if (oChunkArray->uChunks > 1)
+   {
+      uLo = 0;
+      uHi = oChunkArray->uChunks - 1;
+      while (uLo < uHi)
+      {
+         size_t uMid = uLo + (uHi - uLo + 1) / 2;
+         psChunk = oChunkArray->ppsChunks[uMid];
+         iCompare = (*pfCompare)(psChunk->ppvElements[0],
+                                 pvSoughtElement);
+         if (iCompare == 0)
+         {
+            oChunkArray->uCursor = uMid;
+            ChunkArray_fixStarts(oChunkArray, uMid);
+            *puIndex = oChunkArray->puStarts[uMid];
+            return 1;
+         }
+         if (iCompare < 0)
+            uLo = uMid;
+         else
+            uHi = uMid - 1;
+      }
+      uChunk = uLo;
+      psChunk = oChunkArray->ppsChunks[uChunk];
+      oChunkArray->uCursor = uChunk;
+   }
+
+   /* then within that chunk: [uLo, uHi) is still in question */
+   ChunkArray_fixStarts(oChunkArray, uChunk);
+   uStart = oChunkArray->puStarts[uChunk];
+   uLo = 0;
+   uHi = psChunk->uLength;
+   while (uLo < uHi)
+   {
+      size_t uMid = uLo + (uHi - uLo) / 2;
+      iCompare = (*pfCompare)(psChunk->ppvElements[uMid],
+                              pvSoughtElement);
+      if (iCompare == 0)
+      {
+         *puIndex = uStart + uMid;
+         return 1;
+      }
+      if (iCompare < 0)
+         uLo = uMid + 1;
+      else
+         uHi = uMid;
+   }
+   *puIndex = uStart + uLo;
+   return 0;
+}
@@ -0,0 +1,129 @@
+/*--------------------------------------------------------------------*/
+/* chunkarray.h                                                       */
+/* Author: Zara Hommez                                                */
+/*--------------------------------------------------------------------*/
+
+#ifndef CHUNKARRAY_INCLUDED
+#define CHUNKARRAY_INCLUDED
+
+#include <stddef.h>
+#include "region.h"
+#include "slab.h"
+
+/* A ChunkArray_T object is an indexed sequence, like a DynArray_T,
+   that is stored as a list of chunks of at most about sqrt k
+   elements each, k being the most elements it has held. Inserting or
+   removing at any index moves at most one chunk's worth of elements
+   and updates at most the list of chunks, so it takes O(sqrt k) time,
+   and a sorted sequence of k elements is built in O(k sqrt k) time
+   rather than O(k^2). Getting the element just after the one last
+   found, or at an index just returned by ChunkArray_bsearch, takes
+   constant time; getting any other takes O(log k) time if nothing
+   was added or removed since the last get, and O(sqrt k) otherwise,
+   as the chunks' start indexes are brought up to date. */
+
+typedef struct ChunkArray *ChunkArray_T;
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new, empty ChunkArray_T object, or NULL if insufficient
+   memory is available. */
+
+ChunkArray_T ChunkArray_new(void);
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new, empty ChunkArray_T object whose memory, header
+   included, all comes from oRegion, or NULL if insufficient memory is
+   available. ChunkArray_new(), which does not use a region, is the
+   same as ChunkArray_newIn(NULL). */
+
+ChunkArray_T ChunkArray_newIn(Region_T oRegion);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oChunkArray. */
+
+void ChunkArray_free(ChunkArray_T oChunkArray);
+
+/*--------------------------------------------------------------------*/
+
+/* Make oChunkArray, which must be empty, call (*pfMoved)(pvElement,
+   pvChunk) whenever element pvElement is placed in a chunk, whether
+   on being added or when its chunk is split, merged or reallocated.
+   pvChunk is an opaque handle, valid until the next such call for
+   pvElement, that ChunkArray_removeElement accepts. */
+
+void ChunkArray_setTracker(ChunkArray_T oChunkArray,
+                           void (*pfMoved)(void *pvElement,
+                                           void *pvChunk));
+
+/*--------------------------------------------------------------------*/
+
+/* Fill *psStats with the counters of the slab that ChunkArray_T
+   headers are allocated from. */
+
+void ChunkArray_getSlabStats(struct Slab_Stats *psStats);
+
+/*--------------------------------------------------------------------*/
+
+/* Free the slab that ChunkArray_T headers are allocated from, with
+   its pages, if no header from it is in use. The next ChunkArray_T
+   made outside a region makes a new one. */
+
+void ChunkArray_freeSlab(void);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the length of oChunkArray. */
+
+size_t ChunkArray_getLength(ChunkArray_T oChunkArray);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the uIndex'th element of oChunkArray. */
+
+void *ChunkArray_get(ChunkArray_T oChunkArray, size_t uIndex);
+
+/*--------------------------------------------------------------------*/
+
+/* Add pvElement to oChunkArray such that it is the uIndex'th element.
+   Return 1 (TRUE) if successful, or 0 (FALSE) if insufficient memory
+   is available. */
+
+int ChunkArray_addAt(ChunkArray_T oChunkArray, size_t uIndex,
+                     const void *pvElement);
+
+/*--------------------------------------------------------------------*/
+
+/* Remove and return the uIndex'th element of oChunkArray. */
+
+void *ChunkArray_removeAt(ChunkArray_T oChunkArray, size_t uIndex);
+
+/*--------------------------------------------------------------------*/
+
+/* Remove pvElement, which must be in oChunkArray, from it, given the
+   chunk handle its tracker was last told of (see
+   ChunkArray_setTracker). Only that chunk is scanned for it, by
+   identity: no element is compared, and no work is done per chunk. */
+
+void ChunkArray_removeElement(ChunkArray_T oChunkArray, void *pvChunk,
+                              const void *pvElement);
+
+/*--------------------------------------------------------------------*/
+
+/* Binary search oChunkArray for *pvSoughtElement using *pfCompare to
+   determine equality.  If the element is found, then assign its
+   index to *puIndex and return 1.  If the element is not found, then
+   assign the index where it would belong to *puIndex and return 0.
+   *pfCompare must return <0, 0, or >0 if *pvElement1 is less than,
+   equal to, or greater than *pvElement2.
+   oChunkArray must be sorted as determined by *pfCompare. */
+
+int ChunkArray_bsearch(ChunkArray_T oChunkArray,
+                       void *pvSoughtElement,
+                       size_t *puIndex,
+                       int (*pfCompare)(const void *pvElement1,
+                                        const void *pvElement2));
+
+#endif
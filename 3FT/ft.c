@@ -10,24 +10,550 @@
 */
 
 #include <assert.h>
+#include <pthread.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "a4def.h"
+#include "bloom.h"
+#include "chunkarray.h"
 #include "ft.h"
 #include "path.h"
-#include "dynarray.h"
+#include "intern.h"
 #include "nodeFT.h"
+#include "pathindex.h"
+#include "region.h"
+#include "sink.h"
 #include "checkerFT.h"
 
+/* The number of slots in the cursor cache: a power of 2 */
+enum { CURSOR_SLOTS = 32 };
+
 /* 1. a flag for being in an initialized state (TRUE) or not (FALSE) */
 static boolean bIsInitialized;
 /* 2. a pointer to the root node in the hierarchy */
 static Node_T oNRoot;
 /* 3. a counter of the number of nodes in the hierarchy */
 static size_t ulCount;
+/* 4. the index from every node's absolute path to the node, or NULL
+   if FT_setPathIndex has not turned it on */
+static PathIndex_T oPIIndex;
+/* 5. the counting Bloom filter over every node's absolute path, or
+   NULL if FT_setBloomFilter has not turned it on */
+static Bloom_T oBFilter;
+/* 6. the false positive rate oBFilter was asked for */
+static double dBloomRate;
+/* 7. the counters FT_getBloomStats reports */
+static struct FT_BloomStats sBloomStats;
+/* 8. whether FT_setCursorCache has turned the cursor cache on */
+static boolean bCursorsOn;
+/* 9. the cursor cache: directories lookups recently went through,
+   each in the slot its path's hash selects (see FT_rememberCursor) */
+static struct cursor {
+   /* the hash of oNDir's absolute path */
+   unsigned long long ullHash;
+   /* the directory, or NULL if this slot is empty */
+   Node_T oNDir;
+} asCursors[CURSOR_SLOTS];
+/* 10. the counters FT_getCursorStats reports */
+static struct FT_CursorStats sCursorStats;
+/* 11. the region every node and child array comes from, or NULL if
+   FT_initWithRegion did not make one */
+static Region_T oRRegion;
+/* 12. the most threads FT_toString and FT_write may use, which
+   FT_setThreads sets */
+static size_t ulThreads = 1;
+/* 13. the stack FT_walkSubtree keeps, for each directory on the path
+   from the walk's first node to the current one, the hash of its path
+   and the identifier of the next child to visit, and its room */
+static struct walkLevel {
+   size_t ulNext;
+   unsigned long long ullHash;
+} *asWalk;
+static size_t ulWalkPhys;
+
+/* The path length that the '\0'-terminated entry points pass to the
+   lookups: no path can be this long, so only the '\0' ends it */
+#define FT_UNBOUNDED ((size_t) -1)
+
+/* The fewest paths FT_setBloomFilter sizes the filter for, so that a
+   small FT does not resize it with every insertion */
+enum { MIN_BLOOM_CAPACITY = 1024 };
+
+
+/* --------------------------------------------------------------------
+
+  The path index and the Bloom filter, each when on, hold every node
+  under the hash its path has as a Path_T (see Path_getPrefixHash). A
+  node's hash extends its parent's by its own name's, so a subtree can
+  be added or removed given only its root's hash.
+*/
+
+/* Returns the hash of the root's path, which is its one component. A
+   deeper node's hash is taken from a path to it (see FT_hashPath),
+   never worked out from its ancestors, which would take a stack as
+   deep as the node. */
+static unsigned long long FT_hashRoot(void) {
+   assert(oNRoot != NULL);
+
+   return Path_extendHash(0, Intern_getHash(Node_getName(oNRoot)));
+}
+
+/* Makes room in asWalk for at least ulLevels levels. Returns TRUE, or
+   FALSE, leaving it as it was, if memory could not be allocated. */
+static boolean FT_reserveWalk(size_t ulLevels) {
+   size_t ulNewPhys = ulWalkPhys == 0 ? 64 : ulWalkPhys;
+   struct walkLevel *psNew;
+
+   if(ulLevels <= ulWalkPhys)
+      return TRUE;
+   while(ulNewPhys < ulLevels)
+      ulNewPhys *= 2;
+   psNew = realloc(asWalk, ulNewPhys * sizeof(struct walkLevel));
+   if(psNew == NULL)
+      return FALSE;
+   asWalk = psNew;
+   ulWalkPhys = ulNewPhys;
+   return TRUE;
+}
+
+/*
+  Calls (*pfVisit)(oNNode, ullHash) for oNNode, whose path hashes to
+  ullHash, and then for each of its descendants in pre-order with
+  their own paths' hashes, stopping at the first call that does not
+  return SUCCESS. Returns the status of that call, SUCCESS if there was
+  none, or MEMORY_ERROR if the walk could not go deeper for want of
+  memory, which FT_reserveWalk can rule out beforehand. The walk
+  follows the parent links back up, keeping each directory's hash and
+  next child in asWalk, which grows with the deepest walk and is kept
+  for the next.
+*/
+static int FT_walkSubtree(Node_T oNNode, unsigned long long ullHash,
+                          int (*pfVisit)(Node_T oNNode,
+                                         unsigned long long ullHash)) {
+   Node_T oNCurr = oNNode;
+   size_t ulLevel = 0;
+   int iStatus;
+
+   assert(oNNode != NULL);
+   assert(pfVisit != NULL);
+
+   iStatus = (*pfVisit)(oNNode, ullHash);
+   if(iStatus != SUCCESS || Node_isFile(oNNode))
+      return iStatus;
+   if(!FT_reserveWalk(1))
+      return MEMORY_ERROR;
+   asWalk[0].ulNext = 0;
+   asWalk[0].ullHash = ullHash;
+
+   for(;;) {
+      struct walkLevel *psLevel = &asWalk[ulLevel];
+      Node_T oNChild = NULL;
+      unsigned long long ullChild;
+
+      if(psLevel->ulNext == Node_getNumChildren(oNCurr)) {
+         if(ulLevel == 0)
+            return SUCCESS;
+         ulLevel--;
+         oNCurr = Node_getParent(oNCurr);
+         continue;
+      }
+
+      (void) Node_getChild(oNCurr, psLevel->ulNext++, &oNChild);
+      ullChild = Path_extendHash(psLevel->ullHash,
+                                 Intern_getHash(Node_getName(oNChild)));
+      iStatus = (*pfVisit)(oNChild, ullChild);
+      if(iStatus != SUCCESS)
+         return iStatus;
+      if(Node_isFile(oNChild))
+         continue;
+
+      if(!FT_reserveWalk(ulLevel + 2))
+         return MEMORY_ERROR;
+      ulLevel++;
+      asWalk[ulLevel].ulNext = 0;
+      asWalk[ulLevel].ullHash = ullChild;
+      oNCurr = oNChild;
+   }
+}
+
+/* Adds oNNode, whose path hashes to ullHash, to the path index.
+   Returns SUCCESS, or MEMORY_ERROR if memory could not be allocated. */
+static int FT_indexOne(Node_T oNNode, unsigned long long ullHash) {
+   return PathIndex_add(oPIIndex, ullHash, oNNode);
+}
+
+/* Removes oNNode, whose path hashes to ullHash, from the path index if
+   it is there. Returns SUCCESS. */
+static int FT_unindexOne(Node_T oNNode, unsigned long long ullHash) {
+   PathIndex_remove(oPIIndex, ullHash, oNNode);
+   return SUCCESS;
+}
+
+/* Adds the path of oNNode, which hashes to ullHash, to the Bloom
+   filter. Returns SUCCESS. */
+static int FT_filterOne(Node_T oNNode, unsigned long long ullHash) {
+   (void) oNNode;
+   Bloom_add(oBFilter, ullHash);
+   return SUCCESS;
+}
+
+/* Visits oNNode for Node_freeVisiting, with *pvHash the hash of the
+   path of the directory the teardown is in: on arriving at oNNode,
+   moves *pvHash down to it and removes it from the path index and the
+   Bloom filter, whichever are on, and on leaving it, moves *pvHash
+   back up to its parent. */
+static void FT_forgetOne(Node_T oNNode, boolean bArriving,
+                         void *pvHash) {
+   unsigned long long *pullHash = pvHash;
+   unsigned long long ullName = Intern_getHash(Node_getName(oNNode));
+
+   if(!bArriving) {
+      *pullHash = Path_retractHash(*pullHash, ullName);
+      return;
+   }
+   *pullHash = Path_extendHash(*pullHash, ullName);
+   if(oPIIndex != NULL)
+      PathIndex_remove(oPIIndex, *pullHash, oNNode);
+   if(oBFilter != NULL)
+      Bloom_remove(oBFilter, *pullHash);
+}
+
+/*
+  Replaces the Bloom filter by one sized for twice the nodes the FT
+  now holds, at the same false positive rate, and fills it from the
+  FT. Returns SUCCESS, or MEMORY_ERROR, leaving the filter as it was,
+  if memory could not be allocated.
+*/
+static int FT_refilter(void) {
+   Bloom_T oBOld = oBFilter;
+
+   oBFilter = Bloom_new(2 * ulCount, dBloomRate);
+   if(oBFilter == NULL) {
+      oBFilter = oBOld;
+      return MEMORY_ERROR;
+   }
+   if(oNRoot != NULL &&
+      FT_walkSubtree(oNRoot, FT_hashRoot(), FT_filterOne) != SUCCESS) {
+      Bloom_free(oBFilter);
+      oBFilter = oBOld;
+      return MEMORY_ERROR;
+   }
+   Bloom_free(oBOld);
+   return SUCCESS;
+}
+
+/* Adds the new subtree rooted at oNFirstNew, made for oPPath, to the
+   path index and the Bloom filter, whichever are on. Returns SUCCESS,
+   or MEMORY_ERROR, leaving the subtree out of both, if memory could
+   not be allocated. */
+static int FT_rememberNew(Node_T oNFirstNew, Path_T oPPath) {
+   unsigned long long ullHash;
+
+   assert(oNFirstNew != NULL);
+   assert(oPPath != NULL);
+
+   /* the new nodes are a chain down to oPPath's last component, so
+      the walks over it, with room for that, cannot fail part way */
+   if((oPIIndex != NULL || oBFilter != NULL) &&
+      !FT_reserveWalk(Path_getDepth(oPPath) -
+                      Node_getDepth(oNFirstNew) + 1))
+      return MEMORY_ERROR;
+
+   ullHash = Path_getPrefixHash(oPPath, Node_getDepth(oNFirstNew));
+   if(oPIIndex != NULL &&
+      FT_walkSubtree(oNFirstNew, ullHash, FT_indexOne) != SUCCESS) {
+      (void) FT_walkSubtree(oNFirstNew, ullHash, FT_unindexOne);
+      return MEMORY_ERROR;
+   }
+   if(oBFilter != NULL)
+      (void) FT_walkSubtree(oNFirstNew, ullHash, FT_filterOne);
+   return SUCCESS;
+}
+
+/*
+  Sets *pullHash to the hash of pcPath, which ends after ulLength bytes
+  or at a '\0', whichever comes first, as Path_getPrefixHash would
+  give it, and returns the number of bytes before that end. A
+  malformed path still gets a hash, which no node's path has.
+*/
+static size_t FT_hashPath(const char *pcPath, size_t ulLength,
+                          unsigned long long *pullHash) {
+   const char *pcStart = pcPath;
+   const char *pcEnd;
+   const char *pcLimit = NULL;
+   unsigned long long ullHash = 0;
+
+   assert(pcPath != NULL);
+   assert(pullHash != NULL);
+
+   if(ulLength != FT_UNBOUNDED)
+      pcLimit = pcPath + ulLength;
+   for(;;) {
+      pcEnd = pcStart;
+      while(pcEnd != pcLimit && *pcEnd != '/' && *pcEnd != '\0')
+         pcEnd++;
+      ullHash = Path_extendHash(ullHash,
+         Intern_hash(pcStart, (size_t) (pcEnd - pcStart)));
+      if(pcEnd == pcLimit || *pcEnd == '\0')
+         break;
+      pcStart = pcEnd + 1;
+   }
+   *pullHash = ullHash;
+   return (size_t) (pcEnd - pcPath);
+}
+
+/*
+  Returns the node whose absolute path is pcPath, which ends after
+  ulLength bytes or at a '\0', whichever comes first, if the path index
+  holds it, and NULL otherwise. A malformed path is simply not found.
+*/
+static Node_T FT_findIndexed(const char *pcPath, size_t ulLength) {
+   unsigned long long ullHash;
+
+   assert(pcPath != NULL);
+   assert(oPIIndex != NULL);
+
+   ulLength = FT_hashPath(pcPath, ulLength, &ullHash);
+   return PathIndex_find(oPIIndex, ullHash, pcPath, ulLength);
+}
+
+/*
+  Returns FALSE if the Bloom filter is on and shows that no node has
+  the path pcPath, which ends after ulLength bytes or at a '\0',
+  whichever comes first, and TRUE otherwise, in which case the caller
+  looks the path up in the tree and reports whether it found it with
+  FT_countWalk.
+*/
+static boolean FT_mayContain(const char *pcPath, size_t ulLength) {
+   unsigned long long ullHash;
+
+   assert(pcPath != NULL);
+
+   if(oBFilter == NULL)
+      return TRUE;
+   sBloomStats.ulQueries++;
+   (void) FT_hashPath(pcPath, ulLength, &ullHash);
+   if(Bloom_mayContain(oBFilter, ullHash))
+      return TRUE;
+   sBloomStats.ulRuledOut++;
+   return FALSE;
+}
+
+/* Counts a tree walk that FT_mayContain let through, which found its
+   path if bFound is TRUE and was a false positive if not. */
+static void FT_countWalk(boolean bFound) {
+   if(oBFilter == NULL)
+      return;
+   sBloomStats.ulTreeWalks++;
+   if(!bFound)
+      sBloomStats.ulFalsePositives++;
+}
+
+/* --------------------------------------------------------------------
+
+  The cursor cache, when on, remembers the directories that recent
+  lookups went through, so that a lookup near a recent one (a sibling,
+  say) can resume its descent there instead of at the root. A slot
+  holds only a node and its path's hash; an entry is trusted only once
+  the node's path has been checked against the one being looked up,
+  and FT_freeSubtree empties the slot of any node it frees.
+*/
+
+/* Remembers directory oNDir, whose path hashes to ullHash, in the
+   cursor cache, in place of whatever its slot held. */
+static void FT_rememberCursor(Node_T oNDir, unsigned long long ullHash) {
+   struct cursor *psCursor = &asCursors[(size_t) ullHash &
+                                        (CURSOR_SLOTS - 1)];
+
+   assert(oNDir != NULL);
+   assert(!Node_isFile(oNDir));
+
+   psCursor->ullHash = ullHash;
+   psCursor->oNDir = oNDir;
+}
+
+/* Returns the directory the cursor cache holds under ullHash, which
+   may still have some other path with that hash, or NULL if none. */
+static Node_T FT_cursorFor(unsigned long long ullHash) {
+   struct cursor *psCursor = &asCursors[(size_t) ullHash &
+                                        (CURSOR_SLOTS - 1)];
+
+   if(psCursor->oNDir == NULL || psCursor->ullHash != ullHash)
+      return NULL;
+   return psCursor->oNDir;
+}
+
+/* Empties every slot of the cursor cache that holds oNNode or one of
+   its descendants, which are about to be freed. Each slot's directory
+   is checked by climbing from it to oNNode's depth, so this takes time
+   proportional to the cache's size and the tree's depth, whatever the
+   size of oNNode's subtree. */
+static void FT_forgetCursors(Node_T oNNode) {
+   size_t ulDepth, ulSlot;
+
+   assert(oNNode != NULL);
+
+   ulDepth = Node_getDepth(oNNode);
+   for(ulSlot = 0; ulSlot < CURSOR_SLOTS; ulSlot++) {
+      Node_T oNUp = asCursors[ulSlot].oNDir;
+
+      if(oNUp == NULL)
+         continue;
+      while(Node_getDepth(oNUp) > ulDepth)
+         oNUp = Node_getParent(oNUp);
+      if(oNUp == oNNode)
+         asCursors[ulSlot].oNDir = NULL;
+   }
+}
+
+/* Counts a hit in the cursor cache on oNDir, which saves the lookups
+   of every component of its path but the root's. */
+static void FT_countCursorHit(Node_T oNDir) {
+   sCursorStats.ulHits++;
+   sCursorStats.ulLevelsSkipped += Node_getDepth(oNDir) - 1;
+}
+
+/* Returns TRUE if the first ulDepth components of oPPath make up
+   oNNode's absolute path. Both hold interned components, so each
+   level is a pointer comparison. */
+static boolean FT_nodeIsPrefix(Node_T oNNode, Path_T oPPath,
+                               size_t ulDepth) {
+   assert(oNNode != NULL);
+   assert(oPPath != NULL);
+
+   if(Node_getDepth(oNNode) != ulDepth)
+      return FALSE;
+   while(oNNode != NULL) {
+      ulDepth--;
+      if(Node_getName(oNNode) != Path_getComponent(oPPath, ulDepth))
+         return FALSE;
+      oNNode = Node_getParent(oNNode);
+   }
+   return TRUE;
+}
+
+/*
+  Returns the deepest of oPPath's proper prefixes deeper than the root,
+  or oPPath itself, that the cursor cache holds as a directory, setting
+  *poNDir to that directory, or returns 1, leaving *poNDir alone, if
+  the cache holds none. The result is the depth of the prefix found.
+*/
+static size_t FT_resumeTraversal(Path_T oPPath, Node_T *poNDir) {
+   size_t ulDepth;
 
+   assert(oPPath != NULL);
+   assert(poNDir != NULL);
+
+   sCursorStats.ulLookups++;
+   for(ulDepth = Path_getDepth(oPPath); ulDepth > 1; ulDepth--) {
+      Node_T oNDir = FT_cursorFor(Path_getPrefixHash(oPPath, ulDepth));
+      if(oNDir != NULL && FT_nodeIsPrefix(oNDir, oPPath, ulDepth)) {
+         FT_countCursorHit(oNDir);
+         *poNDir = oNDir;
+         return ulDepth;
+      }
+   }
+   return 1;
+}
+
+/*
+  Looks pcPath, which ends after ulLength bytes or at a '\0', whichever
+  comes first, up in the cursor cache's entry for its parent directory.
+  If the cache holds that directory, sets *piStatus to the status
+  FT_findNode is to return for pcPath and *poNResult to the node found,
+  or NULL, and returns TRUE. Otherwise returns FALSE. Either way sets
+  *pullParent to the hash of pcPath's parent's path, or to 0 if pcPath
+  has only one component, for the caller to remember the parent by.
+*/
+static boolean FT_findFromCursor(const char *pcPath, size_t ulLength,
+                                 Node_T *poNResult, int *piStatus,
+                                 unsigned long long *pullParent) {
+   const char *pcStart = pcPath;
+   const char *pcEnd;
+   const char *pcLimit = NULL;
+   unsigned long long ullHash = 0;
+   Node_T oNDir;
+
+   assert(pcPath != NULL);
+   assert(poNResult != NULL);
+   assert(piStatus != NULL);
+   assert(pullParent != NULL);
+
+   /* hash every component but the last */
+   if(ulLength != FT_UNBOUNDED)
+      pcLimit = pcPath + ulLength;
+   for(;;) {
+      pcEnd = pcStart;
+      while(pcEnd != pcLimit && *pcEnd != '/' && *pcEnd != '\0')
+         pcEnd++;
+      if(pcEnd == pcLimit || *pcEnd == '\0')
+         break;
+      ullHash = Path_extendHash(ullHash,
+         Intern_hash(pcStart, (size_t) (pcEnd - pcStart)));
+      pcStart = pcEnd + 1;
+   }
+   *pullParent = ullHash;
+   if(pcStart == pcPath)
+      return FALSE;
+
+   /* a parent that matches a directory's path exactly is well formed,
+      so only the last component is left to check */
+   sCursorStats.ulLookups++;
+   oNDir = FT_cursorFor(ullHash);
+   if(oNDir == NULL ||
+      !Node_matchesPath(oNDir, pcPath, (size_t) (pcStart - 1 - pcPath)))
+      return FALSE;
+   FT_countCursorHit(oNDir);
+
+   *poNResult = NULL;
+   if(pcEnd == pcStart)
+      *piStatus = BAD_PATH;
+   else if(Node_findChild(oNDir, pcStart, (size_t) (pcEnd - pcStart),
+                          poNResult))
+      *piStatus = SUCCESS;
+   else
+      *piStatus = NO_SUCH_PATH;
+   return TRUE;
+}
+
+#ifndef NDEBUG
+/* Returns TRUE if the path index is off or holds as many nodes as the
+   FT does. */
+static boolean FT_pathIndexIsValid(void) {
+   struct PathIndex_Stats sStats;
+
+   if(oPIIndex == NULL)
+      return TRUE;
+   PathIndex_getStats(oPIIndex, &sStats);
+   return sStats.ulEntries == ulCount;
+}
+#endif
+
+/* Frees the subtree rooted at oNNode, which was found at pcPath, of at
+   most ulLength bytes, and returns the number of nodes freed. Any of
+   its directories in the cursor cache are dropped first; its nodes
+   leave the path index and the Bloom filter, whichever are on, as the
+   teardown reaches them, with no separate walk of the subtree. */
+static size_t FT_freeSubtree(Node_T oNNode, const char *pcPath,
+                             size_t ulLength) {
+   unsigned long long ullHash;
+
+   assert(oNNode != NULL);
+   assert(pcPath != NULL);
+
+   if(bCursorsOn)
+      FT_forgetCursors(oNNode);
+   if(oPIIndex == NULL && oBFilter == NULL)
+      return Node_free(oNNode);
+
+   /* the teardown starts in oNNode's parent */
+   (void) FT_hashPath(pcPath, ulLength, &ullHash);
+   ullHash = Path_retractHash(ullHash,
+                              Intern_getHash(Node_getName(oNNode)));
+   return Node_freeVisiting(oNNode, FT_forgetOne, &ullHash);
+}
 
 /* --------------------------------------------------------------------
 
@@ -46,21 +572,18 @@ static size_t ulCount;
 SUCCESS status , with *poNFurthest set to the node of the file. 
 Otherwise, sets *poNFurthest to NULL and returns with status:
   * CONFLICTING_PATH if the root's path is not a prefix of oPPath
-  * MEMORY_ERROR if memory could not be allocated to complete request
 */
 /* short description for reference: 
 traverse and return status , changing poNFurthest to node of 
-farthest depth found of given path*/
+farthest depth found of given path. Children are matched against
+oPPath's components directly, so no prefix paths are allocated */
 
 static int FT_traversePath(Path_T oPPath, Node_T *poNFurthest,
                            boolean *pbFoundFile) {
-   int iStatus;
-   Path_T oPPrefix = NULL;
    Node_T oNCurr;
    Node_T oNChild = NULL;
    size_t ulDepth;
    size_t i;
-   size_t ulChildID;
 
    assert(oPPath != NULL);
    assert(poNFurthest != NULL);
@@ -74,26 +597,21 @@ static int FT_traversePath(Path_T oPPath, Node_T *poNFurthest,
       return SUCCESS;
    }
 
-   /* get first prefix of path (depth 1)*/
-   iStatus = Path_prefix(oPPath, 1, &oPPrefix);
-   if(iStatus != SUCCESS) {
-      *poNFurthest = NULL;
-      return iStatus;
-   }
-
    /* if root path is not a prefix of path, return CONFLICTING_PATH */
-   /* standardization with comparePath != 0 not specified in dtGood -> check*/
-   if(Path_comparePath(Node_getPath(oNRoot), oPPrefix)) {
-      Path_free(oPPrefix);
+   if(strcmp(Node_getName(oNRoot),
+             Path_getComponent(oPPath, 0))) {
       *poNFurthest = NULL;
       return CONFLICTING_PATH;
    }
-   Path_free(oPPrefix);
-   oPPrefix = NULL;
 
    oNCurr = oNRoot;
+   i = 1;
+   if(bCursorsOn)
+      i = FT_resumeTraversal(oPPath, &oNCurr);
+
+   for(; i < ulDepth; i++) {
+      const char *pcComponent;
 
-   for(i = 2; i <= ulDepth; i++) {
       if(Node_isFile(oNCurr)) {
          /* can't go further, found file */
          *poNFurthest = oNCurr;
@@ -101,103 +619,155 @@ static int FT_traversePath(Path_T oPPath, Node_T *poNFurthest,
          return SUCCESS;
       }
 
-      iStatus = Path_prefix(oPPath, i, &oPPrefix);
-      if(iStatus != SUCCESS) {
-         *poNFurthest = NULL;
-         return iStatus;
-      }
-
-      if(Node_hasChild(oNCurr, oPPrefix, &ulChildID)) {
-         /* go to that child and continue with next prefix */
-         Path_free(oPPrefix);
-         oPPrefix = NULL;
-         iStatus = Node_getChild(oNCurr, ulChildID, &oNChild);
-         if(iStatus != SUCCESS) {
-            *poNFurthest = NULL;
-            return iStatus;
-         }
+      pcComponent = Path_getComponent(oPPath, i);
+      if(Node_findChild(oNCurr, pcComponent, strlen(pcComponent),
+                        &oNChild)) {
+         /* go to that child and continue with next component */
          oNCurr = oNChild;
       }
       else {
-         /* oNCurr doesn't have child with path oPPrefix:
+         /* oNCurr doesn't have child with this component:
             this is as far as we can go */
          break;
       }
    }
 
-   Path_free(oPPrefix);
-   oPPrefix = NULL;
+   if(bCursorsOn && !Node_isFile(oNCurr))
+      FT_rememberCursor(oNCurr,
+                        Path_getPrefixHash(oPPath, Node_getDepth(oNCurr)));
    *poNFurthest = oNCurr;
    return SUCCESS;
 }
 
 
 /*
-  Traverses the FT to find a node with absolute path pcPath. Returns a
-  int SUCCESS status and sets *poNResult to be the node, if found.
-  Otherwise, sets *poNResult to NULL and returns with status:
+  Traverses the FT to find a node with absolute path pcPath, which
+  ends after ulLength bytes or at a '\0', whichever comes first.
+  Returns a int SUCCESS status and sets *poNResult to be the node, if
+  found. Otherwise, sets *poNResult to NULL and returns with status:
   * INITIALIZATION_ERROR if the FT is not in an initialized state
   * BAD_PATH if pcPath does not represent a well-formatted path
   * CONFLICTING_PATH if the root's path is not a prefix of pcPath
   * NO_SUCH_PATH if no node with pcPath exists in the hierarchy
   * NOT_A_DIRECTORY if a proper prefix of pcPath exists as a file
-  * MEMORY_ERROR if memory could not be allocated to complete request
  */
- /* short reference: returns node(of given path) if found and null if not w error status */
-
-static int FT_findNode(const char *pcPath, Node_T *poNResult) {
-   Path_T oPPath = NULL;
-   Node_T oNFound = NULL;
-   int iStatus;
-   boolean bFoundFile = FALSE;
+ /* short reference: returns node(of given path) if found and null if
+ not w error status. Validates pcPath with the same rules as Path_new
+ and descends the tree during that one left-to-right scan, so no
+ Path_T is built. Once the descent stops, the rest of pcPath is still
+ scanned because a malformed path must report BAD_PATH first. */
+
+static int FT_findNode(const char *pcPath, size_t ulLength,
+                       Node_T *poNResult) {
+   const char *pcStart = pcPath;
+   const char *pcEnd;
+   const char *pcLimit;
+   Node_T oNCurr = NULL;
+   Node_T oNChild = NULL;
+   size_t ulComponent;
+   size_t ulLevels = 0;
+   unsigned long long ullParent = 0;
+   /* result of the descent so far: SUCCESS while still matching */
+   int iStatus = SUCCESS;
 
    assert(pcPath != NULL);
    assert(poNResult != NULL);
-   /*don't have to assert bFoundFile this time since it isn't a pointer*/ 
 
-   if(!bIsInitialized) {
-      *poNResult = NULL;
+   *poNResult = NULL;
+
+   if(!bIsInitialized)
       return INITIALIZATION_ERROR;
-   }
 
-   iStatus = Path_new(pcPath, &oPPath);
-   if(iStatus != SUCCESS) {
-      *poNResult = NULL;
-      return iStatus;
+   /* a path the index does not hold is still looked up below, which
+      finds the reason it is not in the tree */
+   if(oPIIndex != NULL) {
+      *poNResult = FT_findIndexed(pcPath, ulLength);
+      if(*poNResult != NULL)
+         return SUCCESS;
    }
 
-   iStatus = FT_traversePath(oPPath, &oNFound, &bFoundFile);
-   if(iStatus != SUCCESS) {
-      Path_free(oPPath);
-      *poNResult = NULL;
+   if(bCursorsOn &&
+      FT_findFromCursor(pcPath, ulLength, poNResult, &iStatus,
+                        &ullParent))
       return iStatus;
-   }
 
-   if(oNFound == NULL) {
-      Path_free(oPPath);
-      *poNResult = NULL;
-      return NO_SUCH_PATH;
+   /* one past the last byte that may be read, or NULL if only the
+      '\0' ends pcPath */
+   if(ulLength == FT_UNBOUNDED)
+      pcLimit = NULL;
+   else
+      pcLimit = pcPath + ulLength;
+
+   for(;;) {
+      /* component can't be empty: this rejects the empty path, a
+         leading or doubled delimiter, and a trailing one */
+      if(pcStart == pcLimit || *pcStart == '/' || *pcStart == '\0')
+         return BAD_PATH;
+
+      /* the common '\0'-terminated case gets a loop without the
+         bounds test, which measurably slows deep lookups */
+      pcEnd = pcStart;
+      if(pcLimit == NULL) {
+         while(*pcEnd != '/' && *pcEnd != '\0')
+            pcEnd++;
+      }
+      else {
+         while(pcEnd != pcLimit && *pcEnd != '/' && *pcEnd != '\0')
+            pcEnd++;
+      }
+      ulComponent = (size_t) (pcEnd - pcStart);
+      ulLevels++;
+
+      if(iStatus == SUCCESS) {
+         if(pcStart == pcPath) {
+            /* first component must name the root */
+            if(oNRoot == NULL)
+               iStatus = NO_SUCH_PATH;
+            else if(strncmp(Node_getName(oNRoot), pcStart, ulComponent)
+                    || Node_getName(oNRoot)[ulComponent] != '\0')
+               iStatus = CONFLICTING_PATH;
+            else
+               oNCurr = oNRoot;
+         }
+         /* file shouldn't have children to point to in path*/
+         else if(Node_isFile(oNCurr))
+            iStatus = NOT_A_DIRECTORY;
+         else if(Node_findChild(oNCurr, pcStart, ulComponent, &oNChild))
+            oNCurr = oNChild;
+         else
+            iStatus = NO_SUCH_PATH;
+      }
+
+      if(pcEnd == pcLimit || *pcEnd == '\0')
+         break;
+      pcStart = pcEnd + 1;
    }
 
-   /* check if paths not identical, meaning node wasn't found*/
-   if(Path_comparePath(Node_getPath(oNFound), oPPath)) {
-      Path_free(oPPath);
-      *poNResult = NULL;
-      /* file shouldn't have children to point to in path*/
-      if(bFoundFile)
-         return NOT_A_DIRECTORY;
-      else
-         return NO_SUCH_PATH;
+   /* remember the directory the last component was looked up in */
+   if(bCursorsOn && ulLevels > 1) {
+      if(iStatus == SUCCESS)
+         FT_rememberCursor(Node_getParent(oNCurr), ullParent);
+      else if(iStatus == NO_SUCH_PATH && oNCurr != NULL &&
+              Node_getDepth(oNCurr) + 1 == ulLevels)
+         FT_rememberCursor(oNCurr, ullParent);
    }
 
-   Path_free(oPPath);
-   *poNResult = oNFound;
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   *poNResult = oNCurr;
    return SUCCESS;
 }
 
 /*--------------------------------------------------------------------*/
 
 int FT_insertDir(const char *pcPath) {
+   assert(pcPath != NULL);
+
+   return FT_insertDirN(pcPath, strlen(pcPath));
+}
+
+int FT_insertDirN(const char *pcPath, size_t ulPathLength) {
    int iStatus;
    Path_T oPPath = NULL;
    Node_T oNFirstNew = NULL;
@@ -212,7 +782,7 @@ int FT_insertDir(const char *pcPath) {
    if(!bIsInitialized)
       return INITIALIZATION_ERROR;
 
-   iStatus = Path_new(pcPath, &oPPath);
+   iStatus = Path_newN(pcPath, ulPathLength, &oPPath);
    if(iStatus != SUCCESS)
       return iStatus;
 
@@ -241,9 +811,10 @@ int FT_insertDir(const char *pcPath) {
    if(oNCurr == NULL)
       ulIndex = 1;
    else {
-      ulIndex = Path_getDepth(Node_getPath(oNCurr)) + 1;
-      /* exact path provided already found*/
-      if(Path_comparePath(Node_getPath(oNCurr), oPPath) == 0) {
+      ulIndex = Node_getDepth(oNCurr) + 1;
+      /* exact path provided already found: the traversal matched
+         every component of oNCurr, so equal depth means equal path */
+      if(ulIndex == ulDepth + 1) {
          Path_free(oPPath);
          return ALREADY_IN_TREE;
       }
@@ -281,17 +852,34 @@ int FT_insertDir(const char *pcPath) {
       ulIndex++;
    }
 
+   iStatus = FT_rememberNew(oNFirstNew, oPPath);
    Path_free(oPPath);
+   if(iStatus != SUCCESS) {
+      (void) Node_free(oNFirstNew);
+      assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+      return iStatus;
+   }
 
    if(oNRoot == NULL)
       oNRoot = oNFirstNew;
    ulCount += ulNewNodes;
+   /* a fuller filter only has more false positives, so failing to
+      resize it is not an error */
+   if(oBFilter != NULL && ulCount > Bloom_getCapacity(oBFilter))
+      (void) FT_refilter();
 
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+   assert(FT_pathIndexIsValid());
    return SUCCESS;
 }
 
 boolean FT_containsDir(const char *pcPath) {
+   assert(pcPath != NULL);
+
+   return FT_containsDirN(pcPath, FT_UNBOUNDED);
+}
+
+boolean FT_containsDirN(const char *pcPath, size_t ulPathLength) {
    int iStatus;
    Node_T oNFound = NULL;
 
@@ -300,7 +888,11 @@ boolean FT_containsDir(const char *pcPath) {
    if(!bIsInitialized)
       return FALSE;
 
-   iStatus = FT_findNode(pcPath, &oNFound);
+   if(!FT_mayContain(pcPath, ulPathLength))
+      return FALSE;
+
+   iStatus = FT_findNode(pcPath, ulPathLength, &oNFound);
+   FT_countWalk((boolean) (iStatus == SUCCESS));
    if(iStatus != SUCCESS)
       return FALSE;
 
@@ -310,6 +902,12 @@ boolean FT_containsDir(const char *pcPath) {
 }
 
 int FT_rmDir(const char *pcPath) {
+   assert(pcPath != NULL);
+
+   return FT_rmDirN(pcPath, FT_UNBOUNDED);
+}
+
+int FT_rmDirN(const char *pcPath, size_t ulPathLength) {
    int iStatus;
    Node_T oNFound = NULL;
 
@@ -320,7 +918,7 @@ int FT_rmDir(const char *pcPath) {
    if(!bIsInitialized)
       return INITIALIZATION_ERROR;
 
-   iStatus = FT_findNode(pcPath, &oNFound);
+   iStatus = FT_findNode(pcPath, ulPathLength, &oNFound);
    if(iStatus != SUCCESS)
       return iStatus;
 
@@ -328,18 +926,26 @@ int FT_rmDir(const char *pcPath) {
       return NOT_A_DIRECTORY;
 
    /* lowers the count of the # nodes removed in the subtree of oNfound*/
-   ulCount -= Node_free(oNFound);
+   ulCount -= FT_freeSubtree(oNFound, pcPath, ulPathLength);
    /* if the count is zero, that means the node was the root and eliminated the tree*/
    if(ulCount == 0)
       oNRoot = NULL;
    
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+   assert(FT_pathIndexIsValid());
    return SUCCESS;
 }
 
 /* check oppath bs oppreix correct */
 int FT_insertFile(const char *pcPath, void *pvContents,
                   size_t ulLength) {
+   assert(pcPath != NULL);
+
+   return FT_insertFileN(pcPath, strlen(pcPath), pvContents, ulLength);
+}
+
+int FT_insertFileN(const char *pcPath, size_t ulPathLength,
+                   void *pvContents, size_t ulLength) {
    int iStatus;
    Path_T oPPath = NULL;
    Node_T oNFirstNew = NULL;
@@ -355,7 +961,7 @@ int FT_insertFile(const char *pcPath, void *pvContents,
    if(!bIsInitialized)
       return INITIALIZATION_ERROR;
 
-   iStatus = Path_new(pcPath, &oPPath);
+   iStatus = Path_newN(pcPath, ulPathLength, &oPPath);
    if(iStatus != SUCCESS)
       return iStatus;
 
@@ -380,11 +986,10 @@ int FT_insertFile(const char *pcPath, void *pvContents,
    if(oNCurr == NULL)
       ulIndex = 1;
    else {
-      ulIndex = Path_getDepth(Node_getPath(oNCurr)) + 1;
+      ulIndex = Node_getDepth(oNCurr) + 1;
 
       /* path is already in the tree */
-      if(ulIndex == ulDepth+1 && 
-         Path_comparePath(Node_getPath(oNCurr), oPPath) == 0) {
+      if(ulIndex == ulDepth+1) {
          Path_free(oPPath);
          return ALREADY_IN_TREE;
       }
@@ -434,17 +1039,34 @@ int FT_insertFile(const char *pcPath, void *pvContents,
       ulIndex++;
    }
 
+   iStatus = FT_rememberNew(oNFirstNew, oPPath);
    Path_free(oPPath);
+   if(iStatus != SUCCESS) {
+      (void) Node_free(oNFirstNew);
+      assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+      return iStatus;
+   }
 
    if(oNRoot == NULL)
       oNRoot = oNFirstNew;
    ulCount += ulNewNodes;
+   /* a fuller filter only has more false positives, so failing to
+      resize it is not an error */
+   if(oBFilter != NULL && ulCount > Bloom_getCapacity(oBFilter))
+      (void) FT_refilter();
 
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+   assert(FT_pathIndexIsValid());
    return SUCCESS;
 }
 
 boolean FT_containsFile(const char *pcPath) {
+   assert(pcPath != NULL);
+
+   return FT_containsFileN(pcPath, FT_UNBOUNDED);
+}
+
+boolean FT_containsFileN(const char *pcPath, size_t ulPathLength) {
    int iStatus;
    Node_T oNFound = NULL;
 
@@ -453,7 +1075,11 @@ boolean FT_containsFile(const char *pcPath) {
    if(!bIsInitialized)
       return FALSE;
 
-   iStatus = FT_findNode(pcPath, &oNFound);
+   if(!FT_mayContain(pcPath, ulPathLength))
+      return FALSE;
+
+   iStatus = FT_findNode(pcPath, ulPathLength, &oNFound);
+   FT_countWalk((boolean) (iStatus == SUCCESS));
    if(iStatus != SUCCESS)
       return FALSE;
 
@@ -461,6 +1087,12 @@ boolean FT_containsFile(const char *pcPath) {
 }
 
 int FT_rmFile(const char *pcPath) {
+   assert(pcPath != NULL);
+
+   return FT_rmFileN(pcPath, FT_UNBOUNDED);
+}
+
+int FT_rmFileN(const char *pcPath, size_t ulPathLength) {
    int iStatus;
    Node_T oNFound = NULL;
 
@@ -470,7 +1102,7 @@ int FT_rmFile(const char *pcPath) {
    if(!bIsInitialized)
       return INITIALIZATION_ERROR;
 
-   iStatus = FT_findNode(pcPath, &oNFound);
+   iStatus = FT_findNode(pcPath, ulPathLength, &oNFound);
    if(iStatus != SUCCESS)
       return iStatus;
 
@@ -478,16 +1110,23 @@ int FT_rmFile(const char *pcPath) {
    if(!Node_isFile(oNFound))
       return NOT_A_FILE;
 
-   ulCount -= Node_free(oNFound);
+   ulCount -= FT_freeSubtree(oNFound, pcPath, ulPathLength);
    if(ulCount == 0) { 
       oNRoot = NULL;
    }
 
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+   assert(FT_pathIndexIsValid());
    return SUCCESS;
 }
 
 void *FT_getFileContents(const char *pcPath) {
+   assert(pcPath != NULL);
+
+   return FT_getFileContentsN(pcPath, FT_UNBOUNDED);
+}
+
+void *FT_getFileContentsN(const char *pcPath, size_t ulPathLength) {
    int iStatus;
    Node_T oNFound = NULL;
 
@@ -497,7 +1136,11 @@ void *FT_getFileContents(const char *pcPath) {
    if(!bIsInitialized)
       return NULL;
 
-   iStatus = FT_findNode(pcPath, &oNFound);
+   if(!FT_mayContain(pcPath, ulPathLength))
+      return NULL;
+
+   iStatus = FT_findNode(pcPath, ulPathLength, &oNFound);
+   FT_countWalk((boolean) (iStatus == SUCCESS));
    if(iStatus != SUCCESS)
       return NULL;
 
@@ -509,6 +1152,14 @@ void *FT_getFileContents(const char *pcPath) {
 
 void *FT_replaceFileContents(const char *pcPath, void *pvNewContents,
                              size_t ulNewLength) {
+   assert(pcPath != NULL);
+
+   return FT_replaceFileContentsN(pcPath, FT_UNBOUNDED, pvNewContents,
+                                  ulNewLength);
+}
+
+void *FT_replaceFileContentsN(const char *pcPath, size_t ulPathLength,
+                              void *pvNewContents, size_t ulNewLength) {
    int iStatus;
    Node_T oNFound = NULL;
 
@@ -517,7 +1168,11 @@ void *FT_replaceFileContents(const char *pcPath, void *pvNewContents,
    if(!bIsInitialized)
       return NULL;
 
-   iStatus = FT_findNode(pcPath, &oNFound);
+   if(!FT_mayContain(pcPath, ulPathLength))
+      return NULL;
+
+   iStatus = FT_findNode(pcPath, ulPathLength, &oNFound);
+   FT_countWalk((boolean) (iStatus == SUCCESS));
    if(iStatus != SUCCESS)
       return NULL;
 
@@ -528,6 +1183,13 @@ void *FT_replaceFileContents(const char *pcPath, void *pvNewContents,
 }
 
 int FT_stat(const char *pcPath, boolean *pbIsFile, size_t *pulSize) {
+   assert(pcPath != NULL);
+
+   return FT_statN(pcPath, FT_UNBOUNDED, pbIsFile, pulSize);
+}
+
+int FT_statN(const char *pcPath, size_t ulPathLength, boolean *pbIsFile,
+             size_t *pulSize) {
    int iStatus;
    Node_T oNFound = NULL;
 
@@ -536,7 +1198,7 @@ int FT_stat(const char *pcPath, boolean *pbIsFile, size_t *pulSize) {
    assert(pulSize != NULL);
 
    /* handles potential path problems*/
-   iStatus = FT_findNode(pcPath, &oNFound);
+   iStatus = FT_findNode(pcPath, ulPathLength, &oNFound);
    if(iStatus != SUCCESS)
       return iStatus;
 
@@ -552,12 +1214,28 @@ int FT_stat(const char *pcPath, boolean *pbIsFile, size_t *pulSize) {
 }
 
 int FT_init(void) {
+   return FT_initWithIndex(FT_INDEX_HASH);
+}
+
+int FT_initWithIndex(enum FT_ChildIndex eIndex) {
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
 
    /* can't initialize FT if already done*/
    if(bIsInitialized)
       return INITIALIZATION_ERROR;
 
+   switch(eIndex) {
+      case FT_INDEX_SORTED:
+         Node_setChildIndex(NODE_INDEX_SORTED);
+         break;
+      case FT_INDEX_ART:
+         Node_setChildIndex(NODE_INDEX_ART);
+         break;
+      default:
+         Node_setChildIndex(NODE_INDEX_HASH);
+         break;
+   }
+
    bIsInitialized = TRUE;
    oNRoot = NULL;
    ulCount = 0;
@@ -566,16 +1244,53 @@ int FT_init(void) {
    return SUCCESS;
 }
 
+int FT_initWithRegion(enum FT_ChildIndex eIndex, boolean bHugePages) {
+   int iStatus;
+
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   if(bIsInitialized)
+      return INITIALIZATION_ERROR;
+
+   oRRegion = Region_new(bHugePages);
+   if(oRRegion == NULL)
+      return MEMORY_ERROR;
+   iStatus = FT_initWithIndex(eIndex);
+   assert(iStatus == SUCCESS);
+   Node_setRegion(oRRegion);
+   return iStatus;
+}
+
 int FT_destroy(void) {
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
 
    if(!bIsInitialized)
       return INITIALIZATION_ERROR;
 
-   if(oNRoot != NULL) {
-      ulCount -= Node_free(oNRoot);
-      oNRoot = NULL;
+   /* a region's nodes go with it, unvisited */
+   if(oRRegion != NULL) {
+      Node_setRegion(NULL);
+      Region_free(oRRegion);
+      oRRegion = NULL;
+      ulCount = 0;
    }
+   else if(oNRoot != NULL)
+      ulCount -= Node_free(oNRoot);
+   oNRoot = NULL;
+   PathIndex_free(oPIIndex);
+   oPIIndex = NULL;
+   Bloom_free(oBFilter);
+   oBFilter = NULL;
+   bCursorsOn = FALSE;
+   memset(asCursors, 0, sizeof(asCursors));
+   ulThreads = 1;
+   free(asWalk);
+   asWalk = NULL;
+   ulWalkPhys = 0;
+   /* with the last node gone, give back what held the tree's nodes
+      and names */
+   Node_freeSlabs();
+   Intern_trim();
 
    bIsInitialized = FALSE;
 
@@ -583,90 +1298,683 @@ int FT_destroy(void) {
    return SUCCESS;
 }
 
+int FT_setPathIndex(boolean bEnable) {
+   PathIndex_T oPINew;
+
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
+
+   if(!bEnable) {
+      PathIndex_free(oPIIndex);
+      oPIIndex = NULL;
+      return SUCCESS;
+   }
+   if(oPIIndex != NULL)
+      return SUCCESS;
+
+   oPINew = PathIndex_new();
+   if(oPINew == NULL)
+      return MEMORY_ERROR;
+   oPIIndex = oPINew;
+   if(oNRoot != NULL &&
+      FT_walkSubtree(oNRoot, FT_hashRoot(), FT_indexOne) != SUCCESS) {
+      PathIndex_free(oPIIndex);
+      oPIIndex = NULL;
+      return MEMORY_ERROR;
+   }
+
+   assert(FT_pathIndexIsValid());
+   return SUCCESS;
+}
+
+void FT_getPathIndexStats(struct FT_PathIndexStats *psStats) {
+   struct PathIndex_Stats sStats;
+
+   assert(psStats != NULL);
+
+   memset(psStats, 0, sizeof(*psStats));
+   if(oPIIndex == NULL)
+      return;
+
+   PathIndex_getStats(oPIIndex, &sStats);
+   psStats->ulEntries = sStats.ulEntries;
+   psStats->ulSlots = sStats.ulSlots;
+   psStats->ulBytes = sStats.ulBytes;
+   psStats->ulLookups = sStats.ulLookups;
+   psStats->ulHits = sStats.ulHits;
+   psStats->ulProbes = sStats.ulProbes;
+}
+
+int FT_setBloomFilter(double dFalsePositiveRate) {
+   Bloom_T oBNew, oBOld;
+   size_t ulCapacity = 2 * ulCount;
+
+   assert(dFalsePositiveRate == 0 ||
+          (dFalsePositiveRate > 0 && dFalsePositiveRate < 1));
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
+
+   if(dFalsePositiveRate == 0) {
+      Bloom_free(oBFilter);
+      oBFilter = NULL;
+      return SUCCESS;
+   }
+
+   if(ulCapacity < MIN_BLOOM_CAPACITY)
+      ulCapacity = MIN_BLOOM_CAPACITY;
+   oBNew = Bloom_new(ulCapacity, dFalsePositiveRate);
+   if(oBNew == NULL)
+      return MEMORY_ERROR;
+   oBOld = oBFilter;
+   oBFilter = oBNew;
+   if(oNRoot != NULL &&
+      FT_walkSubtree(oNRoot, FT_hashRoot(), FT_filterOne) != SUCCESS) {
+      Bloom_free(oBNew);
+      oBFilter = oBOld;
+      return MEMORY_ERROR;
+   }
+   Bloom_free(oBOld);
+   dBloomRate = dFalsePositiveRate;
+   memset(&sBloomStats, 0, sizeof(sBloomStats));
+   return SUCCESS;
+}
+
+void FT_getBloomStats(struct FT_BloomStats *psStats) {
+   assert(psStats != NULL);
+
+   memset(psStats, 0, sizeof(*psStats));
+   if(oBFilter == NULL)
+      return;
+
+   *psStats = sBloomStats;
+   psStats->ulCapacity = Bloom_getCapacity(oBFilter);
+   psStats->ulHashes = Bloom_getHashCount(oBFilter);
+   psStats->ulBytes = Bloom_getBytes(oBFilter);
+}
+
+int FT_setCursorCache(boolean bEnable) {
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
+
+   bCursorsOn = bEnable;
+   memset(asCursors, 0, sizeof(asCursors));
+   memset(&sCursorStats, 0, sizeof(sCursorStats));
+   return SUCCESS;
+}
+
+void FT_getCursorStats(struct FT_CursorStats *psStats) {
+   assert(psStats != NULL);
+
+   *psStats = sCursorStats;
+}
+
+void FT_getSlabStats(struct FT_SlabStats *psStats) {
+   struct Slab_Stats sNodes, sArrays;
+
+   assert(psStats != NULL);
+
+   Node_getSlabStats(&sNodes);
+   ChunkArray_getSlabStats(&sArrays);
+   psStats->ulNodesLive = sNodes.ulLive;
+   psStats->ulNodesPeak = sNodes.ulPeak;
+   psStats->ulArraysLive = sArrays.ulLive;
+   psStats->ulArraysPeak = sArrays.ulPeak;
+   psStats->ulBytes = sNodes.ulBytes + sArrays.ulBytes;
+}
+
 /*--------------------------------------------------------------------*/
 
-static size_t FT_preOrderTraversal(Node_T n, DynArray_T d, size_t i) {
-   size_t nChildIdx;
-
-   assert(d != NULL);
-
-   if(n != NULL) {
-      (void) DynArray_set(d, i, n);
-      i++;
-
-      if(!Node_isFile(n)) {
-         
-         size_t ulNumChildren = Node_getNumChildren(n);
-         
-         /* handles files and then directories at each 
-         level through two seperate runs of the children 
-         recursive calls */
-
-         for(nChildIdx = 0; nChildIdx < ulNumChildren; nChildIdx++) {
-            Node_T oNChild = NULL;
-            int iStatus = Node_getChild(n, nChildIdx, &oNChild);
-            assert(iStatus == SUCCESS);
-            if(Node_isFile(oNChild))
-               i = FT_preOrderTraversal(oNChild, d, i);
-         }
+/* The state of an FT_write: the path of the node being visited,
+   built up and cut back one component at a time, and, for that node
+   and each of its ancestors, the identifier of the next child to
+   visit. Both grow with the tree's depth, not its size. */
+struct pathWriter {
+   /* the path, with room for a '\n' after it */
+   char *pcPath;
+   size_t ulLength;
+   size_t ulPhys;
+   /* pulNext[i] is for the node at depth i + 1 on the path */
+   size_t *pulNext;
+   size_t ulDepthPhys;
+};
+
+/* Extends psWriter's path from oNNode's parent's to oNNode's own,
+   writes it to oSSink as a line, and starts on oNNode's children.
+   Returns SUCCESS, or MEMORY_ERROR if memory could not be allocated or
+   the write failed. */
+static int FT_enterNode(struct pathWriter *psWriter, Node_T oNNode,
+                        Sink_T oSSink) {
+   const char *pcName;
+   size_t ulNameLength, ulDepth, ulNeeded;
+
+   assert(psWriter != NULL);
+   assert(oNNode != NULL);
+   assert(oSSink != NULL);
+
+   pcName = Node_getName(oNNode);
+   ulNameLength = Intern_getLength(pcName);
+   ulDepth = Node_getDepth(oNNode);
+
+   /* the separator, the name and the '\n' */
+   ulNeeded = psWriter->ulLength + 1 + ulNameLength + 1;
+   if(ulNeeded > psWriter->ulPhys) {
+      size_t ulNewPhys = 2 * ulNeeded;
+      char *pcNew = realloc(psWriter->pcPath, ulNewPhys);
+
+      if(pcNew == NULL)
+         return MEMORY_ERROR;
+      psWriter->pcPath = pcNew;
+      psWriter->ulPhys = ulNewPhys;
+   }
+   if(ulDepth > psWriter->ulDepthPhys) {
+      size_t ulNewPhys = 2 * ulDepth;
+      size_t *pulNew = realloc(psWriter->pulNext,
+                               ulNewPhys * sizeof(size_t));
+
+      if(pulNew == NULL)
+         return MEMORY_ERROR;
+      psWriter->pulNext = pulNew;
+      psWriter->ulDepthPhys = ulNewPhys;
+   }
 
-         for(nChildIdx = 0; nChildIdx < ulNumChildren; nChildIdx++) {
-            Node_T oNChild = NULL;
-            int iStatus = Node_getChild(n, nChildIdx, &oNChild);
-            assert(iStatus == SUCCESS);
-            if(!Node_isFile(oNChild))
-               i = FT_preOrderTraversal(oNChild, d, i);
-         }
+   if(ulDepth > 1)
+      psWriter->pcPath[psWriter->ulLength++] = '/';
+   memcpy(psWriter->pcPath + psWriter->ulLength, pcName, ulNameLength);
+   psWriter->ulLength += ulNameLength;
+   psWriter->pulNext[ulDepth - 1] = 0;
+
+   psWriter->pcPath[psWriter->ulLength] = '\n';
+   if(!Sink_write(oSSink, psWriter->pcPath, psWriter->ulLength + 1))
+      return MEMORY_ERROR;
+   return SUCCESS;
+}
+
+/* Cuts psWriter's path back from oNNode's to its parent's. */
+static void FT_leaveNode(struct pathWriter *psWriter, Node_T oNNode) {
+   assert(psWriter != NULL);
+   assert(oNNode != NULL);
+
+   psWriter->ulLength -= Intern_getLength(Node_getName(oNNode));
+   if(Node_getDepth(oNNode) > 1)
+      psWriter->ulLength--;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Empties psWriter's path and its record of children to visit. */
+static void FT_initWriter(struct pathWriter *psWriter) {
+   assert(psWriter != NULL);
+
+   psWriter->pcPath = NULL;
+   psWriter->ulLength = 0;
+   psWriter->ulPhys = 0;
+   psWriter->pulNext = NULL;
+   psWriter->ulDepthPhys = 0;
+}
+
+/* Sets psWriter's path, which must be empty, to oNNode's absolute
+   path, followed by a '\n' so that it can be written as a line.
+   Returns SUCCESS, or MEMORY_ERROR if memory could not be allocated. */
+static int FT_startWriter(struct pathWriter *psWriter, Node_T oNNode) {
+   size_t ulLength;
+
+   assert(psWriter != NULL);
+   assert(psWriter->ulLength == 0);
+   assert(oNNode != NULL);
+
+   ulLength = Node_getPathLength(oNNode);
+   if(ulLength + 1 > psWriter->ulPhys) {
+      char *pcNew = realloc(psWriter->pcPath, 2 * (ulLength + 1));
+
+      if(pcNew == NULL)
+         return MEMORY_ERROR;
+      psWriter->pcPath = pcNew;
+      psWriter->ulPhys = 2 * (ulLength + 1);
+   }
+   psWriter->ulLength = Node_writePath(oNNode, psWriter->pcPath);
+   psWriter->pcPath[psWriter->ulLength] = '\n';
+   return SUCCESS;
+}
+
+/* Writes the lines of oNTop's subtree to oSSink in pre-order, given
+   psWriter with the path of oNTop's parent (empty for the root), which
+   it is left with again. Returns SUCCESS, or MEMORY_ERROR if memory
+   could not be allocated or a write failed. */
+static int FT_writeSubtree(struct pathWriter *psWriter, Node_T oNTop,
+                           Sink_T oSSink) {
+   Node_T oNCurr;
+   int iStatus;
+
+   assert(psWriter != NULL);
+   assert(oNTop != NULL);
+   assert(oSSink != NULL);
+
+   /* pre-order without recursion: the parent links lead back up, and
+      each directory's children are numbered files first, then
+      directories, each in order, which is the order required */
+   iStatus = FT_enterNode(psWriter, oNTop, oSSink);
+   oNCurr = oNTop;
+   while(iStatus == SUCCESS) {
+      size_t *pulNext = &psWriter->pulNext[Node_getDepth(oNCurr) - 1];
+
+      if(!Node_isFile(oNCurr) && *pulNext < Node_getNumChildren(oNCurr)) {
+         Node_T oNChild = NULL;
+
+         (void) Node_getChild(oNCurr, (*pulNext)++, &oNChild);
+         iStatus = FT_enterNode(psWriter, oNChild, oSSink);
+         oNCurr = oNChild;
+      }
+      else {
+         FT_leaveNode(psWriter, oNCurr);
+         if(oNCurr == oNTop)
+            break;
+         oNCurr = Node_getParent(oNCurr);
+      }
+   }
+   return iStatus;
+}
+
+/*--------------------------------------------------------------------
+
+  A parallel write cuts the representation into pieces, each a run of
+  consecutive lines, serializes every piece into a buffer of its own
+  on whichever thread takes it, and then puts the buffers together in
+  order. The pieces are cut before any thread starts, and so that no
+  two of them read the same child array: reading one moves its
+  cursor (see ChunkArray_get).
+*/
+
+/* A piece: oNNode's line, if bSelf is TRUE, then the subtrees of the
+   children ulFirst up to ulLast, which are oNNode's children with
+   those identifiers or, if oNNode is NULL, the list's roots at those
+   places. */
+struct piece {
+   Node_T oNNode;
+   boolean bSelf;
+   size_t ulFirst;
+   size_t ulLast;
+   /* the piece's lines once serialized, their length, and where they
+      start in the whole */
+   char *pcText;
+   size_t ulLength;
+   size_t ulOffset;
+   /* SUCCESS, or the reason the piece could not be serialized */
+   int iStatus;
+};
+
+/* The pieces of a parallel write and the state its threads share */
+struct pieceList {
+   /* the pieces, in order */
+   struct piece *psPieces;
+   size_t ulCount;
+   size_t ulPhys;
+   /* subtree roots found while cutting, for pieces with no oNNode */
+   Node_T *poNRoots;
+   size_t ulRoots;
+   size_t ulRootsPhys;
+   /* the place of the next piece for a thread to take, and the lock
+      that guards it */
+   size_t ulNext;
+   pthread_mutex_t sNextLock;
+   /* NULL while the pieces are serialized; then the string they are
+      copied into, each at its ulOffset */
+   char *pcResult;
+};
+
+/* The fewest nodes an FT must have to be serialized in parallel:
+   smaller ones take less time than starting the threads */
+enum { MIN_PARALLEL_NODES = 16 * 1024 };
+
+/* The number of pieces per thread FT_cutPieces aims for: several, so
+   that the threads given small pieces go on to take others */
+enum { PIECES_PER_THREAD = 8 };
+
+/* Appends a piece of oNNode's line, if bSelf is TRUE, and the children
+   ulFirst up to ulLast to psList. Returns SUCCESS, or MEMORY_ERROR if
+   memory could not be allocated. */
+static int FT_addPiece(struct pieceList *psList, Node_T oNNode,
+                       boolean bSelf, size_t ulFirst, size_t ulLast) {
+   struct piece *psPiece;
+
+   assert(psList != NULL);
+
+   if(psList->ulCount == psList->ulPhys) {
+      size_t ulNewPhys = psList->ulPhys == 0 ? 16 : 2 * psList->ulPhys;
+      struct piece *psNew = realloc(psList->psPieces,
+                                    ulNewPhys * sizeof(struct piece));
+
+      if(psNew == NULL)
+         return MEMORY_ERROR;
+      psList->psPieces = psNew;
+      psList->ulPhys = ulNewPhys;
+   }
+   psPiece = &psList->psPieces[psList->ulCount++];
+   psPiece->oNNode = oNNode;
+   psPiece->bSelf = bSelf;
+   psPiece->ulFirst = ulFirst;
+   psPiece->ulLast = ulLast;
+   psPiece->pcText = NULL;
+   psPiece->ulLength = 0;
+   psPiece->ulOffset = 0;
+   psPiece->iStatus = SUCCESS;
+   return SUCCESS;
+}
+
+/* Appends oNSubtree to psList's subtree roots. Returns SUCCESS, or
+   MEMORY_ERROR if memory could not be allocated. */
+static int FT_addRoot(struct pieceList *psList, Node_T oNSubtree) {
+   assert(psList != NULL);
+   assert(oNSubtree != NULL);
+
+   if(psList->ulRoots == psList->ulRootsPhys) {
+      size_t ulNewPhys = psList->ulRootsPhys == 0 ? 64 :
+         2 * psList->ulRootsPhys;
+      Node_T *poNNew = realloc(psList->poNRoots,
+                               ulNewPhys * sizeof(Node_T));
+
+      if(poNNew == NULL)
+         return MEMORY_ERROR;
+      psList->poNRoots = poNNew;
+      psList->ulRootsPhys = ulNewPhys;
+   }
+   psList->poNRoots[psList->ulRoots++] = oNSubtree;
+   return SUCCESS;
+}
+
+/*
+  Appends to psList pieces covering oNNode's line, if bSelf is TRUE,
+  and its children's subtrees, at most about ulBudget of them. Subtree
+  sizes are not kept, so the budget is shared evenly among the
+  subdirectories, each cut in turn; a directory's line and its files
+  make one piece, and subdirectories too many for the budget are
+  grouped into ulBudget runs of siblings. Returns SUCCESS, or
+  MEMORY_ERROR if memory could not be allocated.
+*/
+static int FT_cutPieces(struct pieceList *psList, Node_T oNNode,
+                        boolean bSelf, size_t ulBudget) {
+   size_t ulFiles, ulDirs, i;
+   int iStatus;
+
+   assert(psList != NULL);
+   assert(oNNode != NULL);
+
+   ulFiles = Node_getNumFiles(oNNode);
+   ulDirs = Node_getNumChildren(oNNode) - ulFiles;
+   if(ulBudget <= 1 || ulDirs == 0)
+      return FT_addPiece(psList, oNNode, bSelf, 0, ulFiles + ulDirs);
+
+   if(bSelf || ulFiles != 0) {
+      iStatus = FT_addPiece(psList, oNNode, bSelf, 0, ulFiles);
+      if(iStatus != SUCCESS)
+         return iStatus;
+      ulBudget--;
+   }
+
+   if(ulDirs <= ulBudget) {
+      for(i = 0; i < ulDirs; i++) {
+         Node_T oNChild = NULL;
+         /* the first ulBudget % ulDirs get one more */
+         size_t ulShare = ulBudget / ulDirs +
+            (i < ulBudget % ulDirs ? 1 : 0);
+
+         (void) Node_getChild(oNNode, ulFiles + i, &oNChild);
+         iStatus = FT_cutPieces(psList, oNChild, TRUE, ulShare);
+         if(iStatus != SUCCESS)
+            return iStatus;
+      }
+      return SUCCESS;
+   }
+
+   /* the runs' roots are looked up now, on this thread alone */
+   for(i = 0; i < ulBudget; i++) {
+      size_t ulFirst = psList->ulRoots;
+      size_t ulId = ulFiles + i * ulDirs / ulBudget;
+      size_t ulEnd = ulFiles + (i + 1) * ulDirs / ulBudget;
+
+      for(; ulId < ulEnd; ulId++) {
+         Node_T oNChild = NULL;
+
+         (void) Node_getChild(oNNode, ulId, &oNChild);
+         iStatus = FT_addRoot(psList, oNChild);
+         if(iStatus != SUCCESS)
+            return iStatus;
       }
+      iStatus = FT_addPiece(psList, NULL, FALSE, ulFirst,
+                            psList->ulRoots);
+      if(iStatus != SUCCESS)
+         return iStatus;
    }
+   return SUCCESS;
+}
 
-   return i;
+/* Serializes psPiece, one of psList's, into psPiece->pcText and sets
+   its ulLength, or sets its iStatus to MEMORY_ERROR if memory could
+   not be allocated. */
+static void FT_writePiece(struct pieceList *psList,
+                          struct piece *psPiece) {
+   struct pathWriter sWriter;
+   Sink_T oSSink;
+   size_t ulId;
+   int iStatus = MEMORY_ERROR;
+
+   assert(psList != NULL);
+   assert(psPiece != NULL);
+
+   FT_initWriter(&sWriter);
+   oSSink = Sink_newBuffer();
+   if(oSSink != NULL)
+      iStatus = SUCCESS;
+
+   /* the children's subtrees are written below their parent's path;
+      a run's roots are siblings, none of them the FT's root */
+   if(iStatus == SUCCESS && psPiece->oNNode != NULL) {
+      iStatus = FT_startWriter(&sWriter, psPiece->oNNode);
+      if(iStatus == SUCCESS && psPiece->bSelf &&
+         !Sink_write(oSSink, sWriter.pcPath, sWriter.ulLength + 1))
+         iStatus = MEMORY_ERROR;
+   }
+   else if(iStatus == SUCCESS && psPiece->ulFirst < psPiece->ulLast)
+      iStatus = FT_startWriter(&sWriter, Node_getParent(
+                                  psList->poNRoots[psPiece->ulFirst]));
+   for(ulId = psPiece->ulFirst;
+       iStatus == SUCCESS && ulId < psPiece->ulLast; ulId++) {
+      Node_T oNChild = NULL;
+
+      if(psPiece->oNNode != NULL)
+         (void) Node_getChild(psPiece->oNNode, ulId, &oNChild);
+      else
+         oNChild = psList->poNRoots[ulId];
+      iStatus = FT_writeSubtree(&sWriter, oNChild, oSSink);
+   }
+
+   if(iStatus == SUCCESS) {
+      psPiece->ulLength = Sink_getLength(oSSink);
+      psPiece->pcText = Sink_takeString(oSSink);
+      if(psPiece->pcText == NULL)
+         iStatus = MEMORY_ERROR;
+   }
+   psPiece->iStatus = iStatus;
+
+   Sink_free(oSSink);
+   free(sWriter.pcPath);
+   free(sWriter.pulNext);
 }
 
-static void FT_strlenAccumulate(Node_T oNNode, size_t *pulAcc) {
-   assert(pulAcc != NULL);
+/* Returns the place in psList of the next piece for this thread to
+   work on, which is psList->ulCount once none are left. */
+static size_t FT_takePiece(struct pieceList *psList) {
+   size_t ulIndex;
+
+   assert(psList != NULL);
+
+   pthread_mutex_lock(&psList->sNextLock);
+   ulIndex = psList->ulNext;
+   if(ulIndex < psList->ulCount)
+      psList->ulNext++;
+   pthread_mutex_unlock(&psList->sNextLock);
+   return ulIndex;
+}
+
+/* Takes psList's pieces one at a time until none are left, and either
+   serializes each or, once psList->pcResult is set, copies its text
+   into place there and frees it. Returns NULL; pvList is psList, for
+   pthread_create. */
+static void *FT_workOnPieces(void *pvList) {
+   struct pieceList *psList = pvList;
+   size_t ulIndex;
+
+   assert(psList != NULL);
+
+   while((ulIndex = FT_takePiece(psList)) < psList->ulCount) {
+      struct piece *psPiece = &psList->psPieces[ulIndex];
+
+      if(psList->pcResult == NULL)
+         FT_writePiece(psList, psPiece);
+      else {
+         memcpy(psList->pcResult + psPiece->ulOffset, psPiece->pcText,
+                psPiece->ulLength);
+         free(psPiece->pcText);
+         psPiece->pcText = NULL;
+      }
+   }
+   return NULL;
+}
 
-   if(oNNode != NULL)
-      *pulAcc += (Path_getStrLength(Node_getPath(oNNode)) + 1);
+/* Works through psList's pieces from the start on this thread and as
+   many as ulThreads - 1 others, returning once all are done. A thread
+   that cannot be started leaves its share to the rest. */
+static void FT_runWorkers(struct pieceList *psList) {
+   pthread_t *psThreads;
+   size_t ulWorkers, ulStarted = 0, i;
+
+   assert(psList != NULL);
+
+   psList->ulNext = 0;
+   ulWorkers = ulThreads < psList->ulCount ? ulThreads : psList->ulCount;
+   psThreads = ulWorkers > 1 ?
+      malloc((ulWorkers - 1) * sizeof(pthread_t)) : NULL;
+   if(psThreads != NULL)
+      for(; ulStarted < ulWorkers - 1; ulStarted++)
+         if(pthread_create(&psThreads[ulStarted], NULL, FT_workOnPieces,
+                           psList) != 0)
+            break;
+
+   (void) FT_workOnPieces(psList);
+   for(i = 0; i < ulStarted; i++)
+      (void) pthread_join(psThreads[i], NULL);
+   free(psThreads);
 }
 
-static void FT_strcatAccumulate(Node_T oNNode, char *pcAcc) {
-   assert(pcAcc != NULL);
+/*
+  Writes the representation to oSSink, if ppcResult is NULL, or makes
+  it a new string and sets *ppcResult to that, using up to ulThreads
+  threads. The FT must not be empty. Returns SUCCESS, or MEMORY_ERROR
+  if memory could not be allocated or a write to oSSink failed.
+*/
+static int FT_writeParallel(Sink_T oSSink, char **ppcResult) {
+   struct pieceList sList;
+   size_t ulTotal = 0, i;
+   int iStatus;
 
-   if(oNNode != NULL) {
-      strcat(pcAcc, Path_getPathname(Node_getPath(oNNode)));
-      strcat(pcAcc, "\n");
+   assert(oNRoot != NULL);
+   assert((oSSink == NULL) != (ppcResult == NULL));
+
+   memset(&sList, 0, sizeof(sList));
+   if(pthread_mutex_init(&sList.sNextLock, NULL) != 0)
+      return MEMORY_ERROR;
+   iStatus = FT_cutPieces(&sList, oNRoot, TRUE,
+                          ulThreads * PIECES_PER_THREAD);
+   if(iStatus == SUCCESS)
+      FT_runWorkers(&sList);
+
+   /* each piece's offset is the sum of the lengths before it */
+   for(i = 0; iStatus == SUCCESS && i < sList.ulCount; i++) {
+      iStatus = sList.psPieces[i].iStatus;
+      sList.psPieces[i].ulOffset = ulTotal;
+      ulTotal += sList.psPieces[i].ulLength;
+   }
+
+   if(iStatus == SUCCESS && ppcResult != NULL) {
+      sList.pcResult = malloc(ulTotal + 1);
+      if(sList.pcResult == NULL)
+         iStatus = MEMORY_ERROR;
+      else {
+         FT_runWorkers(&sList);
+         sList.pcResult[ulTotal] = '\0';
+         *ppcResult = sList.pcResult;
+      }
    }
+   for(i = 0; iStatus == SUCCESS && ppcResult == NULL &&
+          i < sList.ulCount; i++)
+      if(!Sink_write(oSSink, sList.psPieces[i].pcText,
+                     sList.psPieces[i].ulLength))
+         iStatus = MEMORY_ERROR;
+
+   for(i = 0; i < sList.ulCount; i++)
+      free(sList.psPieces[i].pcText);
+   free(sList.psPieces);
+   free(sList.poNRoots);
+   pthread_mutex_destroy(&sList.sNextLock);
+   return iStatus;
 }
 
 /*--------------------------------------------------------------------*/
 
+int FT_write(Sink_T oSSink) {
+   struct pathWriter sWriter;
+   int iStatus;
+
+   assert(oSSink != NULL);
+
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
+   if(oNRoot == NULL)
+      return SUCCESS;
+   if(ulThreads > 1 && ulCount >= MIN_PARALLEL_NODES)
+      return FT_writeParallel(oSSink, NULL);
+
+   FT_initWriter(&sWriter);
+   iStatus = FT_writeSubtree(&sWriter, oNRoot, oSSink);
+   free(sWriter.pcPath);
+   free(sWriter.pulNext);
+   return iStatus;
+}
+
 char *FT_toString(void) {
-   DynArray_T nodes;
-   size_t totalStrlen = 1;
-   char *result = NULL;
+   Sink_T oSSink;
+   char *pcResult = NULL;
 
    if(!bIsInitialized)
       return NULL;
 
-   nodes = DynArray_new(ulCount);
-   (void) FT_preOrderTraversal(oNRoot, nodes, 0);
-
-   DynArray_map(nodes, (void (*)(void *, void *)) FT_strlenAccumulate,
-                (void *) &totalStrlen);
+   if(ulThreads > 1 && ulCount >= MIN_PARALLEL_NODES) {
+      (void) FT_writeParallel(NULL, &pcResult);
+      return pcResult;
+   }
 
-   result = malloc(totalStrlen);
-   if(result == NULL) {
-      DynArray_free(nodes);
+   oSSink = Sink_newBuffer();
+   if(oSSink == NULL)
       return NULL;
-   }
-   *result = '\0';
+   if(FT_write(oSSink) == SUCCESS)
+      pcResult = Sink_takeString(oSSink);
+   Sink_free(oSSink);
 
-   DynArray_map(nodes, (void (*)(void *, void *)) FT_strcatAccumulate,
-                (void *) result);
+   return pcResult;
+}
+
+int FT_setThreads(size_t ulMaxThreads) {
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
 
-   DynArray_free(nodes);
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
 
-   return result;
+   ulThreads = ulMaxThreads == 0 ? 1 : ulMaxThreads;
+   return SUCCESS;
 }
 
@@ -14,6 +14,7 @@
 
 #include <stddef.h>
 #include "a4def.h"
+#include "sink.h"
 
 /*
    Inserts a new directory into the FT with absolute path pcPath.
@@ -119,6 +120,27 @@ void *FT_replaceFileContents(const char *pcPath, void *pvNewContents,
 */
 int FT_stat(const char *pcPath, boolean *pbIsFile, size_t *pulSize);
 
+/*
+  Each of the following does the same as the function of the same name
+  without the final N, for the path in the ulPathLength bytes at
+  pcPath, which need not be '\0'-terminated: the path ends early at a
+  '\0' within those bytes, if there is one, and no byte past them is
+  read. The bytes are only borrowed, so a path inside a larger buffer
+  can be passed without first copying it out.
+*/
+int FT_insertDirN(const char *pcPath, size_t ulPathLength);
+boolean FT_containsDirN(const char *pcPath, size_t ulPathLength);
+int FT_rmDirN(const char *pcPath, size_t ulPathLength);
+int FT_insertFileN(const char *pcPath, size_t ulPathLength,
+                   void *pvContents, size_t ulLength);
+boolean FT_containsFileN(const char *pcPath, size_t ulPathLength);
+int FT_rmFileN(const char *pcPath, size_t ulPathLength);
+void *FT_getFileContentsN(const char *pcPath, size_t ulPathLength);
+void *FT_replaceFileContentsN(const char *pcPath, size_t ulPathLength,
+                              void *pvNewContents, size_t ulNewLength);
+int FT_statN(const char *pcPath, size_t ulPathLength, boolean *pbIsFile,
+             size_t *pulSize);
+
 /*
   Sets the FT data structure to an initialized state.
   The data structure is initially empty.
@@ -127,6 +149,159 @@ int FT_stat(const char *pcPath, boolean *pbIsFile, size_t *pulSize);
 */
 int FT_init(void);
 
+/* The index each directory keeps to look up its children by name */
+enum FT_ChildIndex {
+   /* none: binary search the sorted children */
+   FT_INDEX_SORTED,
+   /* a hash table, once a directory has many children (the default) */
+   FT_INDEX_HASH,
+   /* an adaptive radix tree over the names' bytes */
+   FT_INDEX_ART
+};
+
+/*
+  Does the same as FT_init, but makes every directory in the FT index
+  its children with eIndex until the FT is destroyed.
+*/
+int FT_initWithIndex(enum FT_ChildIndex eIndex);
+
+/*
+  Does the same as FT_initWithIndex, but allocates every node of the
+  FT, and its directories' child arrays and indexes, from a region of
+  large blocks that belongs to the FT; if bHugePages is TRUE the blocks
+  are meant to be backed by huge pages. Space freed by FT_rmDir and
+  FT_rmFile is reused within the region, and FT_destroy frees the
+  region whole, without visiting the nodes. File contents still belong
+  to the client.
+  Returns SUCCESS, or:
+  * INITIALIZATION_ERROR if the FT is already in an initialized state
+  * MEMORY_ERROR if memory could not be allocated for the region
+*/
+int FT_initWithRegion(enum FT_ChildIndex eIndex, boolean bHugePages);
+
+/*
+  Turns the FT's path index on if bEnable is TRUE, or off if it is
+  FALSE. While on, the index maps every absolute path in the FT to its
+  node, so a lookup of a path that is in the FT costs one hash and one
+  comparison however deep the path is, in exchange for the memory
+  FT_getPathIndexStats reports; a path that is not in the FT is looked
+  up as before, to find the reason. The index is off after FT_init and
+  is discarded by FT_destroy.
+  Returns SUCCESS, or:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * MEMORY_ERROR if memory could not be allocated to build the index,
+                 in which case it is left off
+*/
+int FT_setPathIndex(boolean bEnable);
+
+/* Counters describing the FT's path index */
+struct FT_PathIndexStats {
+   /* the number of paths indexed: the number of nodes in the FT */
+   size_t ulEntries;
+   /* the number of slots in the index's hash table */
+   size_t ulSlots;
+   /* the bytes the index has allocated: its memory overhead */
+   size_t ulBytes;
+   /* the number of lookups made through the index */
+   size_t ulLookups;
+   /* the number of those lookups that found their path */
+   size_t ulHits;
+   /* the number of table slots those lookups examined */
+   size_t ulProbes;
+};
+
+/* Fills *psStats with the path index's counters, or with zeros if the
+   path index is off. */
+void FT_getPathIndexStats(struct FT_PathIndexStats *psStats);
+
+/*
+  Turns the FT's Bloom filter on, sized for the FT's contents so that a
+  path not in the FT gets past it at most a fraction
+  dFalsePositiveRate of the time, or turns it off if dFalsePositiveRate
+  is 0; it must be 0 or between 0 and 1 exclusive. While on, the
+  filter is consulted by FT_containsDir, FT_containsFile,
+  FT_getFileContents and FT_replaceFileContents (and their N forms)
+  before the path is parsed, and a path it rules out is reported as
+  absent without walking the tree. The filter grows with
+  the FT, keeping its rate. It is off after FT_init and is discarded by
+  FT_destroy.
+  Returns SUCCESS, or:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * MEMORY_ERROR if memory could not be allocated for the filter, in
+                 which case it is left as it was
+*/
+int FT_setBloomFilter(double dFalsePositiveRate);
+
+/* Counters describing the FT's Bloom filter */
+struct FT_BloomStats {
+   /* the number of paths the filter is sized for */
+   size_t ulCapacity;
+   /* the number of counters each path sets */
+   size_t ulHashes;
+   /* the bytes the filter has allocated: its memory overhead */
+   size_t ulBytes;
+   /* the number of paths checked against the filter */
+   size_t ulQueries;
+   /* the number of those the filter ruled out without a tree walk */
+   size_t ulRuledOut;
+   /* the number of those the filter let through to a tree walk */
+   size_t ulTreeWalks;
+   /* the number of those walks that did not find their path */
+   size_t ulFalsePositives;
+};
+
+/* Fills *psStats with the Bloom filter's counters, which
+   FT_setBloomFilter resets, or with zeros if the filter is off. */
+void FT_getBloomStats(struct FT_BloomStats *psStats);
+
+/*
+  Turns the FT's cursor cache on if bEnable is TRUE, or off if it is
+  FALSE. While on, the FT remembers a few directories that recent
+  lookups went through, and a lookup whose path runs through one of
+  them starts its descent there rather than at the root, which pays
+  off when many calls in a row name paths in the same directory. The
+  cache is off after FT_init, starts empty whenever this is called and
+  is discarded by FT_destroy.
+  Returns SUCCESS, or INITIALIZATION_ERROR if the FT is not in an
+  initialized state.
+*/
+int FT_setCursorCache(boolean bEnable);
+
+/* Counters describing the FT's cursor cache */
+struct FT_CursorStats {
+   /* the number of lookups that consulted the cache */
+   size_t ulLookups;
+   /* the number of those that resumed from a cached directory */
+   size_t ulHits;
+   /* the number of levels those hits did not have to descend */
+   size_t ulLevelsSkipped;
+};
+
+/* Fills *psStats with the cursor cache's counters, which
+   FT_setCursorCache resets. */
+void FT_getCursorStats(struct FT_CursorStats *psStats);
+
+/* Counters describing the slabs that nodes and their child arrays are
+   allocated from. The slabs are made with an FT's first node and
+   freed, with their pages, by FT_destroy, so the counters, peaks
+   included, start again from zero with each FT. */
+struct FT_SlabStats {
+   /* the number of nodes allocated and not yet freed */
+   size_t ulNodesLive;
+   /* the most nodes that have been allocated at once */
+   size_t ulNodesPeak;
+   /* the number of directories' child array headers allocated and not
+      yet freed */
+   size_t ulArraysLive;
+   /* the most child array headers that have been allocated at once */
+   size_t ulArraysPeak;
+   /* the bytes both slabs have allocated */
+   size_t ulBytes;
+};
+
+/* Fills *psStats with the node and child array slabs' counters. */
+void FT_getSlabStats(struct FT_SlabStats *psStats);
+
 /*
   Removes all contents of the data structure and
   returns it to an uninitialized state.
@@ -149,4 +324,33 @@ int FT_destroy(void);
 */
 char *FT_toString(void);
 
+/*
+  Writes the representation FT_toString returns, without a '\0', to
+  oSSink, one path at a time as the tree is walked, in time linear in
+  its length and memory proportional to the tree's depth; when
+  FT_setThreads has FT_write use more threads, the whole
+  representation is serialized in pieces first, and then written.
+  oSSink is not flushed. Returns SUCCESS if every write succeeded.
+  Otherwise, returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * MEMORY_ERROR if memory could not be allocated, or if oSSink failed
+    a write (see Sink_write)
+*/
+int FT_write(Sink_T oSSink);
+
+/*
+  Lets FT_toString and FT_write use up to ulMaxThreads threads, the
+  calling thread among them; 0 is taken as 1. With more than one, and
+  an FT large enough to gain from them, the representation is cut
+  into pieces at directories, a few per thread, that the threads
+  serialize into buffers of their own; FT_toString then copies those,
+  also in parallel, into one string at offsets summed from their
+  lengths. The result is the same, byte for byte, as with one thread,
+  which is the default after FT_init and after FT_destroy. The FT must
+  not be changed while either runs.
+  Returns SUCCESS, or INITIALIZATION_ERROR if the FT is not in an
+  initialized state.
+*/
+int FT_setThreads(size_t ulMaxThreads);
+
 #endif
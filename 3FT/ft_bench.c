@@ -0,0 +1,789 @@
+/*--------------------------------------------------------------------*/
+/* ft_bench.c                                                         */
+/* Author: Zara Hommez                                                */
+/*--------------------------------------------------------------------*/
+
+/* for clock_gettime */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "ft.h"
+#include "intern.h"
+#include "path.h"
+
+/* Number of sibling directories created next to each level of the
+   benchmarked path, so that every lookup does a real child search */
+enum { SIBLINGS = 8 };
+
+/* The kinds of child index the benchmarks compare, and their names */
+static const enum FT_ChildIndex aeIndexes[] =
+   { FT_INDEX_SORTED, FT_INDEX_HASH, FT_INDEX_ART };
+static const char *apcIndexNames[] = { "sorted", "hash", "art" };
+enum { INDEX_KINDS = sizeof(aeIndexes) / sizeof(aeIndexes[0]) };
+
+/* Exits with an error message naming pcWhat unless bCond holds. The
+   benchmark is built with NDEBUG, so assert cannot be used here. */
+static void Bench_require(boolean bCond, const char *pcWhat) {
+   if(!bCond) {
+      fprintf(stderr, "ft_bench: %s failed\n", pcWhat);
+      exit(EXIT_FAILURE);
+   }
+}
+
+/* Returns the number of nanoseconds spent per operation when ulOps
+   operations took the clock ticks between clStart and clEnd. */
+static double Bench_nsPerOp(clock_t clStart, clock_t clEnd,
+                            size_t ulOps) {
+   return (double) (clEnd - clStart) * 1e9 / CLOCKS_PER_SEC /
+      (double) ulOps;
+}
+
+/* Returns the time of the monotonic clock in milliseconds: unlike
+   clock, which adds up every thread's time, it measures how long a
+   parallel operation takes to finish. */
+static double Bench_wallMs(void) {
+   struct timespec sNow;
+
+   Bench_require(clock_gettime(CLOCK_MONOTONIC, &sNow) == 0,
+                 "clock_gettime");
+   return (double) sNow.tv_sec * 1e3 + (double) sNow.tv_nsec / 1e6;
+}
+
+/* Inserts into the FT ulFiles empty files named "f0", "f1", ... in
+   directory pcDir, which is made if need be. */
+static void Bench_fillDir(const char *pcDir, size_t ulFiles) {
+   char acPath[64];
+   size_t i;
+
+   for(i = 0; i < ulFiles; i++) {
+      sprintf(acPath, "%s/f%lu", pcDir, (unsigned long) i);
+      Bench_require(FT_insertFile(acPath, NULL, 0) == SUCCESS,
+                    "FT_insertFile");
+   }
+}
+
+/* Writes into pcBuf the path of a file at depth ulDepth + 1 whose
+   directories are named "d0", "d1", ... and returns its length. */
+static size_t Bench_deepPath(char *pcBuf, size_t ulDepth) {
+   size_t i;
+   char *pcInsert = pcBuf;
+
+   for(i = 0; i < ulDepth; i++)
+      pcInsert += sprintf(pcInsert, "d%lu/", (unsigned long) i);
+   pcInsert += sprintf(pcInsert, "file");
+   return (size_t) (pcInsert - pcBuf);
+}
+
+/* Builds an FT holding a file at depth ulDepth + 1 with SIBLINGS
+   directory siblings at every level, with the path index on if
+   bIndexed, then times ulOps rounds of FT_containsFile and FT_stat on
+   that file. */
+static void Bench_lookup(size_t ulDepth, size_t ulOps, boolean bIndexed) {
+   char *pcPath;
+   char *pcSibling;
+   size_t ulLength, ulLevel, ulSib, i;
+   boolean bIsFile;
+   size_t ulSize;
+   clock_t clStart, clEnd;
+
+   pcPath = malloc(ulDepth * 24 + 8);
+   pcSibling = malloc(ulDepth * 24 + 16);
+   Bench_require(pcPath != NULL && pcSibling != NULL, "malloc");
+   ulLength = Bench_deepPath(pcPath, ulDepth);
+
+   Bench_require(FT_init() == SUCCESS, "FT_init");
+   if(bIndexed)
+      Bench_require(FT_setPathIndex(TRUE) == SUCCESS, "FT_setPathIndex");
+   Bench_require(FT_insertFile(pcPath, NULL, 0) == SUCCESS,
+                 "FT_insertFile");
+   for(ulLevel = 1; ulLevel < ulDepth; ulLevel++) {
+      /* the first ulLevel directories of pcPath, then a sibling */
+      char *pcEnd = pcPath;
+      for(i = 0; i < ulLevel; i++)
+         pcEnd = strchr(pcEnd, '/') + 1;
+      for(ulSib = 0; ulSib < SIBLINGS; ulSib++) {
+         memcpy(pcSibling, pcPath, (size_t) (pcEnd - pcPath));
+         sprintf(pcSibling + (pcEnd - pcPath), "s%lu",
+                 (unsigned long) ulSib);
+         Bench_require(FT_insertDir(pcSibling) == SUCCESS,
+                       "FT_insertDir");
+      }
+   }
+
+   clStart = clock();
+   for(i = 0; i < ulOps; i++) {
+      Bench_require(FT_containsFile(pcPath), "FT_containsFile");
+      Bench_require(FT_stat(pcPath, &bIsFile, &ulSize) == SUCCESS,
+                    "FT_stat");
+   }
+   clEnd = clock();
+
+   printf("lookup  depth %3lu  len %4lu  %10.1f ns/op",
+          (unsigned long) ulDepth, (unsigned long) ulLength,
+          Bench_nsPerOp(clStart, clEnd, 2 * ulOps));
+   if(bIndexed) {
+      struct FT_PathIndexStats sStats;
+
+      FT_getPathIndexStats(&sStats);
+      printf("  indexed, %.1f bytes/node",
+             (double) sStats.ulBytes / (double) sStats.ulEntries);
+   }
+   printf("\n");
+
+   Bench_require(FT_destroy() == SUCCESS, "FT_destroy");
+   free(pcSibling);
+   free(pcPath);
+}
+
+/* Times inserting ulPaths directory paths of depth ulDepth that share
+   only the root, so every insert creates ulDepth - 1 new nodes. */
+static void Bench_insert(size_t ulDepth, size_t ulPaths) {
+   char *pcPath;
+   char *pcInsert;
+   size_t i, ulLevel;
+   clock_t clStart, clEnd;
+
+   pcPath = malloc(ulDepth * 32 + 8);
+   Bench_require(pcPath != NULL, "malloc");
+
+   Bench_require(FT_init() == SUCCESS, "FT_init");
+   clStart = clock();
+   for(i = 0; i < ulPaths; i++) {
+      pcInsert = pcPath + sprintf(pcPath, "root");
+      for(ulLevel = 1; ulLevel < ulDepth; ulLevel++)
+         pcInsert += sprintf(pcInsert, "/p%lu_%lu", (unsigned long) i,
+                             (unsigned long) ulLevel);
+      Bench_require(FT_insertDir(pcPath) == SUCCESS, "FT_insertDir");
+   }
+   clEnd = clock();
+
+   printf("insert  depth %3lu  %7lu paths  %10.1f ns/path\n",
+          (unsigned long) ulDepth, (unsigned long) ulPaths,
+          Bench_nsPerOp(clStart, clEnd, ulPaths));
+
+   Bench_require(FT_destroy() == SUCCESS, "FT_destroy");
+   free(pcPath);
+}
+
+/* Times ulOps rounds of Path_new and Path_free on pcPath. */
+static void Bench_path(const char *pcPath, size_t ulOps) {
+   Path_T oPPath;
+   size_t ulDepth = 1;
+   const char *pcCurr;
+   size_t i;
+   clock_t clStart, clEnd;
+
+   for(pcCurr = pcPath; *pcCurr != '\0'; pcCurr++)
+      if(*pcCurr == '/')
+         ulDepth++;
+
+   clStart = clock();
+   for(i = 0; i < ulOps; i++) {
+      Bench_require(Path_new(pcPath, &oPPath) == SUCCESS, "Path_new");
+      Path_free(oPPath);
+   }
+   clEnd = clock();
+
+   printf("path    depth %3lu  len %4lu  %10.1f ns/op\n",
+          (unsigned long) ulDepth, (unsigned long) strlen(pcPath),
+          Bench_nsPerOp(clStart, clEnd, ulOps));
+}
+
+/* Times ulOps rounds of Path_new and Path_free over a fixed set of
+   generated paths whose depths (1 to 14) and component lengths (2 to
+   17 characters) are spread the way a manifest's typically are, and
+   reports how many of them were stored inline. */
+static void Bench_pathMix(size_t ulOps) {
+   enum { PATH_COUNT = 1024, MAX_LENGTH = 14 * 18 };
+   static char aacPaths[PATH_COUNT][MAX_LENGTH + 1];
+   unsigned long ulSeed = 12345;
+   size_t ulTotal = 0;
+   size_t i, ulLevel, ulDepth, ulChar, ulLength;
+   Path_T oPPath;
+   struct Path_Stats sBefore, sStats;
+   clock_t clStart, clEnd;
+
+   for(i = 0; i < PATH_COUNT; i++) {
+      char *pcInsert = aacPaths[i];
+
+      ulSeed = ulSeed * 1103515245UL + 12345UL;
+      ulDepth = 1 + (ulSeed >> 16) % 14;
+      for(ulLevel = 0; ulLevel < ulDepth; ulLevel++) {
+         if(ulLevel > 0)
+            *pcInsert++ = '/';
+         ulSeed = ulSeed * 1103515245UL + 12345UL;
+         ulLength = 2 + (ulSeed >> 16) % 16;
+         for(ulChar = 0; ulChar < ulLength; ulChar++)
+            *pcInsert++ = (char) ('a' + (ulSeed >> (ulChar % 8)) % 26);
+      }
+      *pcInsert = '\0';
+      ulTotal += (size_t) (pcInsert - aacPaths[i]);
+   }
+
+   Path_getStats(&sBefore);
+   clStart = clock();
+   for(i = 0; i < ulOps; i++) {
+      Bench_require(Path_new(aacPaths[i % PATH_COUNT], &oPPath) ==
+                    SUCCESS, "Path_new");
+      Path_free(oPPath);
+   }
+   clEnd = clock();
+   Path_getStats(&sStats);
+   sStats.ulInline -= sBefore.ulInline;
+   sStats.ulSpilled -= sBefore.ulSpilled;
+
+   printf("path    mixed      avg %4lu  %10.1f ns/op  %5.1f%% inline\n",
+          (unsigned long) (ulTotal / PATH_COUNT),
+          Bench_nsPerOp(clStart, clEnd, ulOps),
+          100.0 * (double) sStats.ulInline /
+          (double) (sStats.ulInline + sStats.ulSpilled));
+}
+
+/* Writes a manifest of ulPaths newline-delimited file paths, then
+   times making every path in it with Path_new one line at a time and
+   with one call of Path_newBatchLines. */
+static void Bench_batch(size_t ulPaths) {
+   char *pcBuffer, *pcInsert, *pcLine;
+   char acLine[128];
+   Path_T *poPPaths, *poPBatch;
+   int *piStatuses;
+   size_t ulLength, ulCount, i;
+   clock_t clStart, clEnd;
+   double dSerial;
+
+   pcBuffer = malloc(ulPaths * 64);
+   poPPaths = malloc(ulPaths * sizeof(Path_T));
+   Bench_require(pcBuffer != NULL && poPPaths != NULL, "malloc");
+   pcInsert = pcBuffer;
+   for(i = 0; i < ulPaths; i++)
+      pcInsert += sprintf(pcInsert, "root/src/mod%lu/pkg%lu/file%lu.c\n",
+                          (unsigned long) (i % 97),
+                          (unsigned long) (i % 1013),
+                          (unsigned long) i);
+   ulLength = (size_t) (pcInsert - pcBuffer);
+
+   /* serially: split out each line, as a caller without the batch
+      API would */
+   clStart = clock();
+   pcLine = pcBuffer;
+   for(i = 0; i < ulPaths; i++) {
+      size_t ulLine = (size_t) (strchr(pcLine, '\n') - pcLine);
+      memcpy(acLine, pcLine, ulLine);
+      acLine[ulLine] = '\0';
+      Bench_require(Path_new(acLine, &poPPaths[i]) == SUCCESS,
+                    "Path_new");
+      pcLine += ulLine + 1;
+   }
+   clEnd = clock();
+   dSerial = Bench_nsPerOp(clStart, clEnd, ulPaths);
+   for(i = 0; i < ulPaths; i++)
+      Path_free(poPPaths[i]);
+
+   clStart = clock();
+   Bench_require(Path_newBatchLines(pcBuffer, ulLength, &poPBatch,
+                                    &piStatuses, &ulCount) == SUCCESS,
+                 "Path_newBatchLines");
+   clEnd = clock();
+   Bench_require(ulCount == ulPaths, "Path_newBatchLines count");
+
+   /* clock counts every thread's CPU time, so this is the work done,
+      not the wall time a multi-core machine would see */
+   printf("batch   %7lu paths  serial %6.1f  batch %6.1f ns/path (cpu)\n",
+          (unsigned long) ulPaths, dSerial,
+          Bench_nsPerOp(clStart, clEnd, ulPaths));
+
+   for(i = 0; i < ulCount; i++)
+      Path_free(poPBatch[i]);
+   free(piStatuses);
+   free(poPBatch);
+   free(poPPaths);
+   free(pcBuffer);
+}
+
+/* Times ulOps calls of Path_comparePath on separately made paths
+   from pcPath1 and pcPath2. */
+static void Bench_compare(const char *pcPath1, const char *pcPath2,
+                          size_t ulOps) {
+   Path_T oPPath1, oPPath2;
+   size_t i;
+   int iSum = 0;
+   clock_t clStart, clEnd;
+
+   Bench_require(Path_new(pcPath1, &oPPath1) == SUCCESS, "Path_new");
+   Bench_require(Path_new(pcPath2, &oPPath2) == SUCCESS, "Path_new");
+
+   clStart = clock();
+   for(i = 0; i < ulOps; i++)
+      iSum += Path_comparePath(oPPath1, oPPath2) != 0;
+   clEnd = clock();
+
+   printf("compare %-7s    len %4lu  %10.1f ns/op\n",
+          iSum == 0 ? "equal" : "unequal",
+          (unsigned long) strlen(pcPath1),
+          Bench_nsPerOp(clStart, clEnd, ulOps));
+
+   Path_free(oPPath2);
+   Path_free(oPPath1);
+}
+
+/* Times inserting ulFiles files into a single directory in a random
+   order, so that each lands at a random place among its siblings,
+   and then removing them all with FT_destroy. */
+static void Bench_siblings(size_t ulFiles) {
+   size_t *pulOrder;
+   char acPath[32];
+   size_t i, j, ulTemp;
+   unsigned long ulSeed = 4242;
+   clock_t clStart, clMid, clEnd;
+
+   pulOrder = malloc(ulFiles * sizeof(size_t));
+   Bench_require(pulOrder != NULL, "malloc");
+   for(i = 0; i < ulFiles; i++)
+      pulOrder[i] = i;
+   /* Fisher-Yates shuffle */
+   for(i = ulFiles; i > 1; i--) {
+      ulSeed = ulSeed * 1103515245UL + 12345UL;
+      j = (size_t) ((ulSeed >> 8) % i);
+      ulTemp = pulOrder[i - 1];
+      pulOrder[i - 1] = pulOrder[j];
+      pulOrder[j] = ulTemp;
+   }
+
+   Bench_require(FT_init() == SUCCESS, "FT_init");
+   clStart = clock();
+   for(i = 0; i < ulFiles; i++) {
+      sprintf(acPath, "root/f%lu", (unsigned long) pulOrder[i]);
+      Bench_require(FT_insertFile(acPath, NULL, 0) == SUCCESS,
+                    "FT_insertFile");
+   }
+   clMid = clock();
+   Bench_require(FT_destroy() == SUCCESS, "FT_destroy");
+   clEnd = clock();
+
+   printf("sibling %7lu files  insert %8.1f  destroy %6.1f ns/file\n",
+          (unsigned long) ulFiles,
+          Bench_nsPerOp(clStart, clMid, ulFiles),
+          Bench_nsPerOp(clMid, clEnd, ulFiles));
+   free(pulOrder);
+}
+
+/* Builds a single directory of ulFiles files with children indexed
+   by aeIndexes[ulKind], then times ulOps FT_containsFile calls on
+   files chosen pseudo-randomly among them, so each lookup is dominated
+   by the search of one directory. */
+static void Bench_fanout(size_t ulKind, size_t ulFiles, size_t ulOps) {
+   char acPath[32];
+   size_t i;
+   unsigned long ulSeed = 1717;
+   clock_t clStart, clMid, clEnd;
+
+   Bench_require(FT_initWithIndex(aeIndexes[ulKind]) == SUCCESS,
+                 "FT_initWithIndex");
+   clStart = clock();
+   Bench_fillDir("root", ulFiles);
+
+   clMid = clock();
+   for(i = 0; i < ulOps; i++) {
+      ulSeed = ulSeed * 1103515245UL + 12345UL;
+      sprintf(acPath, "root/f%lu",
+              (unsigned long) ((ulSeed >> 8) % ulFiles));
+      Bench_require(FT_containsFile(acPath), "FT_containsFile");
+   }
+   clEnd = clock();
+
+   printf("fanout  %-6s %7lu files  insert %7.1f  lookup %7.1f ns\n",
+          apcIndexNames[ulKind], (unsigned long) ulFiles,
+          Bench_nsPerOp(clStart, clMid, ulFiles),
+          Bench_nsPerOp(clMid, clEnd, ulOps));
+   Bench_require(FT_destroy() == SUCCESS, "FT_destroy");
+}
+
+/* Times FT_containsFile on paths that are not in an FT of ulFiles
+   files, each missing only its last component, with the Bloom filter
+   at false positive rate dRate, or off if dRate is 0, and reports the
+   filter's counters. */
+static void Bench_misses(double dRate, size_t ulFiles, size_t ulOps) {
+   char acPath[64];
+   size_t i;
+   unsigned long ulSeed = 4242;
+   clock_t clStart, clEnd;
+   struct FT_BloomStats sStats;
+
+   Bench_require(FT_init() == SUCCESS, "FT_init");
+   for(i = 0; i < ulFiles; i++) {
+      sprintf(acPath, "usr/local/share/doc/d%lu/f%lu",
+              (unsigned long) (i % 100), (unsigned long) i);
+      Bench_require(FT_insertFile(acPath, NULL, 0) == SUCCESS,
+                    "FT_insertFile");
+   }
+   if(dRate != 0)
+      Bench_require(FT_setBloomFilter(dRate) == SUCCESS,
+                    "FT_setBloomFilter");
+
+   clStart = clock();
+   for(i = 0; i < ulOps; i++) {
+      ulSeed = ulSeed * 1103515245UL + 12345UL;
+      sprintf(acPath, "usr/local/share/doc/d%lu/g%lu",
+              (unsigned long) ((ulSeed >> 8) % 100),
+              (unsigned long) ((ulSeed >> 12) % ulFiles));
+      Bench_require(!FT_containsFile(acPath), "FT_containsFile");
+   }
+   clEnd = clock();
+
+   FT_getBloomStats(&sStats);
+   printf("misses  bloom %-6g %10.1f ns/op", dRate,
+          Bench_nsPerOp(clStart, clEnd, ulOps));
+   if(dRate != 0)
+      printf("  k %lu  %.1f bytes/path  %lu ruled out  %lu walks  "
+             "%lu false positives",
+             (unsigned long) sStats.ulHashes,
+             (double) sStats.ulBytes / (double) ulFiles,
+             (unsigned long) sStats.ulRuledOut,
+             (unsigned long) sStats.ulTreeWalks,
+             (unsigned long) sStats.ulFalsePositives);
+   printf("\n");
+
+   Bench_require(FT_destroy() == SUCCESS, "FT_destroy");
+}
+
+/* Builds an FT of ulDirs directories at depth ulDepth holding
+   ulPerDir files each, then times FT_stat on every file, one
+   directory after another, with the cursor cache on if bCursors, and
+   reports the cache's hit rate and the levels its hits skipped. */
+static void Bench_listing(size_t ulDepth, size_t ulDirs, size_t ulPerDir,
+                          boolean bCursors) {
+   char acPath[1024];
+   size_t ulPrefix, ulDir, ulFile, i;
+   size_t ulOps = 0;
+   boolean bIsFile;
+   size_t ulSize;
+   clock_t clStart, clEnd;
+   struct FT_CursorStats sStats;
+
+   Bench_require(FT_init() == SUCCESS, "FT_init");
+   ulPrefix = 0;
+   for(i = 1; i < ulDepth; i++)
+      ulPrefix += (size_t) sprintf(acPath + ulPrefix, "level%lu/",
+                                   (unsigned long) i);
+   for(ulDir = 0; ulDir < ulDirs; ulDir++)
+      for(ulFile = 0; ulFile < ulPerDir; ulFile++) {
+         sprintf(acPath + ulPrefix, "dir%lu/file%lu",
+                 (unsigned long) ulDir, (unsigned long) ulFile);
+         Bench_require(FT_insertFile(acPath, NULL, 0) == SUCCESS,
+                       "FT_insertFile");
+      }
+   Bench_require(FT_setCursorCache(bCursors) == SUCCESS,
+                 "FT_setCursorCache");
+
+   clStart = clock();
+   for(i = 0; i < 10; i++)
+      for(ulDir = 0; ulDir < ulDirs; ulDir++)
+         for(ulFile = 0; ulFile < ulPerDir; ulFile++) {
+            sprintf(acPath + ulPrefix, "dir%lu/file%lu",
+                    (unsigned long) ulDir, (unsigned long) ulFile);
+            Bench_require(FT_stat(acPath, &bIsFile, &ulSize) == SUCCESS,
+                          "FT_stat");
+            ulOps++;
+         }
+   clEnd = clock();
+
+   FT_getCursorStats(&sStats);
+   printf("listing cursors %-3s depth %2lu %10.1f ns/op",
+          bCursors ? "on" : "off", (unsigned long) ulDepth,
+          Bench_nsPerOp(clStart, clEnd, ulOps));
+   if(bCursors)
+      printf("  %5.1f%% hits  %4.1f levels skipped per hit",
+             100.0 * (double) sStats.ulHits / (double) sStats.ulLookups,
+             (double) sStats.ulLevelsSkipped / (double) sStats.ulHits);
+   printf("\n");
+
+   Bench_require(FT_destroy() == SUCCESS, "FT_destroy");
+}
+
+/* Times ulRounds rounds of inserting ulFiles files, each in a
+   directory of its own, and removing those directories again, then
+   reports how many nodes and child arrays the slabs held at most. */
+static void Bench_churn(size_t ulFiles, size_t ulRounds) {
+   char acPath[64];
+   size_t ulRound, i;
+   clock_t clStart, clEnd;
+   struct FT_SlabStats sStats;
+
+   Bench_require(FT_init() == SUCCESS, "FT_init");
+   clStart = clock();
+   for(ulRound = 0; ulRound < ulRounds; ulRound++) {
+      for(i = 0; i < ulFiles; i++) {
+         sprintf(acPath, "churn/d%lu/f", (unsigned long) i);
+         Bench_require(FT_insertFile(acPath, NULL, 0) == SUCCESS,
+                       "FT_insertFile");
+      }
+      for(i = 0; i < ulFiles; i++) {
+         sprintf(acPath, "churn/d%lu", (unsigned long) i);
+         Bench_require(FT_rmDir(acPath) == SUCCESS, "FT_rmDir");
+      }
+   }
+   clEnd = clock();
+
+   FT_getSlabStats(&sStats);
+   printf("churn   %lu files  %10.1f ns/op  nodes %lu live %lu peak  "
+          "arrays %lu live %lu peak  %lu slab bytes\n",
+          (unsigned long) ulFiles,
+          Bench_nsPerOp(clStart, clEnd, 2 * ulFiles * ulRounds),
+          (unsigned long) sStats.ulNodesLive,
+          (unsigned long) sStats.ulNodesPeak,
+          (unsigned long) sStats.ulArraysLive,
+          (unsigned long) sStats.ulArraysPeak,
+          (unsigned long) sStats.ulBytes);
+
+   Bench_require(FT_destroy() == SUCCESS, "FT_destroy");
+}
+
+/* Builds an FT of ulFiles files, 100 to a directory, with its nodes
+   in a region if bRegion (of huge-page blocks if bHugePages), and
+   times inserting them and tearing the FT down with FT_destroy. */
+static void Bench_teardown(size_t ulFiles, boolean bRegion,
+                           boolean bHugePages) {
+   char acPath[64];
+   size_t i;
+   clock_t clStart, clBuilt, clEnd;
+
+   if(bRegion)
+      Bench_require(FT_initWithRegion(FT_INDEX_HASH, bHugePages) ==
+                    SUCCESS, "FT_initWithRegion");
+   else
+      Bench_require(FT_init() == SUCCESS, "FT_init");
+
+   clStart = clock();
+   for(i = 0; i < ulFiles; i++) {
+      sprintf(acPath, "data/d%lu/f%lu", (unsigned long) (i / 100),
+              (unsigned long) (i % 100));
+      Bench_require(FT_insertFile(acPath, NULL, 0) == SUCCESS,
+                    "FT_insertFile");
+   }
+   clBuilt = clock();
+   Bench_require(FT_destroy() == SUCCESS, "FT_destroy");
+   clEnd = clock();
+
+   printf("teardown %-7s %8lu files  insert %7.1f ns/file  "
+          "destroy %9.3f ms\n",
+          bRegion ? (bHugePages ? "huge" : "region") : "malloc",
+          (unsigned long) ulFiles,
+          Bench_nsPerOp(clStart, clBuilt, ulFiles),
+          (double) (clEnd - clBuilt) * 1e3 / CLOCKS_PER_SEC);
+}
+
+/* Times FT_rmDir on a directory of ulFiles files, with each kind of
+   child index. */
+static void Bench_rmDir(size_t ulFiles) {
+   size_t ulKind;
+   clock_t clStart, clEnd;
+
+   for(ulKind = 0; ulKind < INDEX_KINDS; ulKind++) {
+      Bench_require(FT_initWithIndex(aeIndexes[ulKind]) == SUCCESS,
+                    "FT_initWithIndex");
+      Bench_fillDir("top/big", ulFiles);
+      clStart = clock();
+      Bench_require(FT_rmDir("top/big") == SUCCESS, "FT_rmDir");
+      clEnd = clock();
+      printf("rmdir   %-6s %8lu files %9.3f ms\n", apcIndexNames[ulKind],
+             (unsigned long) ulFiles,
+             (double) (clEnd - clStart) * 1e3 / CLOCKS_PER_SEC);
+      Bench_require(FT_destroy() == SUCCESS, "FT_destroy");
+   }
+}
+
+/* Times removing, one FT_rmFile at a time and in a scattered order,
+   each of the ulFiles files of one directory, with each kind of child
+   index. */
+static void Bench_rmFile(size_t ulFiles) {
+   /* coprime with any ulFiles that is a power of 10 */
+   enum { STRIDE = 7919 };
+   char acPath[64];
+   size_t ulKind, i;
+   clock_t clStart, clEnd;
+
+   for(ulKind = 0; ulKind < INDEX_KINDS; ulKind++) {
+      Bench_require(FT_initWithIndex(aeIndexes[ulKind]) == SUCCESS,
+                    "FT_initWithIndex");
+      Bench_fillDir("top/big", ulFiles);
+      clStart = clock();
+      for(i = 0; i < ulFiles; i++) {
+         sprintf(acPath, "top/big/f%lu",
+                 (unsigned long) (i * STRIDE % ulFiles));
+         Bench_require(FT_rmFile(acPath) == SUCCESS, "FT_rmFile");
+      }
+      clEnd = clock();
+      printf("rmfile  %-6s %8lu files %8.1f ns/file\n",
+             apcIndexNames[ulKind], (unsigned long) ulFiles,
+             Bench_nsPerOp(clStart, clEnd, ulFiles));
+      Bench_require(FT_destroy() == SUCCESS, "FT_destroy");
+   }
+}
+
+/* Builds an FT of ulDirs directories, each holding ulPerDir files
+   and as many subdirectories of one file each, with files and
+   subdirectories interleaved by name, then times FT_toString on it,
+   and FT_write to a file descriptor sink on /dev/null, and then
+   FT_toString again with 1, 2 and 4 threads, checking that each
+   string matches the serial one byte for byte. */
+static void Bench_toString(size_t ulDirs, size_t ulPerDir) {
+   char acPath[128];
+   size_t ulDir, ulChild, ulThreads, i;
+   size_t ulLength = 0;
+   char *pcString, *pcSerial = NULL;
+   Sink_T oSSink;
+   int iFd;
+   clock_t clStart, clEnd, clWritten;
+
+   Bench_require(FT_init() == SUCCESS, "FT_init");
+   for(ulDir = 0; ulDir < ulDirs; ulDir++)
+      for(ulChild = 0; ulChild < ulPerDir; ulChild++) {
+         sprintf(acPath, "root/dir%lu/file%lu", (unsigned long) ulDir,
+                 (unsigned long) ulChild);
+         Bench_require(FT_insertFile(acPath, NULL, 0) == SUCCESS,
+                       "FT_insertFile");
+         sprintf(acPath, "root/dir%lu/file%lux/leaf",
+                 (unsigned long) ulDir, (unsigned long) ulChild);
+         Bench_require(FT_insertFile(acPath, NULL, 0) == SUCCESS,
+                       "FT_insertFile");
+      }
+
+   clStart = clock();
+   for(i = 0; i < 10; i++) {
+      free(pcSerial);
+      pcSerial = FT_toString();
+      Bench_require(pcSerial != NULL, "FT_toString");
+   }
+   clEnd = clock();
+   ulLength = strlen(pcSerial);
+
+   iFd = open("/dev/null", O_WRONLY);
+   Bench_require(iFd >= 0, "open");
+   oSSink = Sink_newFd(iFd);
+   Bench_require(oSSink != NULL, "Sink_newFd");
+   for(i = 0; i < 10; i++)
+      Bench_require(FT_write(oSSink) == SUCCESS, "FT_write");
+   Bench_require(Sink_flush(oSSink), "Sink_flush");
+   clWritten = clock();
+   Sink_free(oSSink);
+   (void) close(iFd);
+
+   printf("tostring %7lu nodes %9lu bytes %8.3f ms  fd %8.3f ms\n",
+          (unsigned long) (1 + ulDirs * (1 + 3 * ulPerDir)),
+          (unsigned long) ulLength,
+          (double) (clEnd - clStart) * 1e3 / CLOCKS_PER_SEC / 10,
+          (double) (clWritten - clEnd) * 1e3 / CLOCKS_PER_SEC / 10);
+
+   /* the same string again, by wall clock, as threads are added */
+   for(ulThreads = 1; ulThreads <= 4; ulThreads *= 2) {
+      double dStart;
+
+      Bench_require(FT_setThreads(ulThreads) == SUCCESS, "FT_setThreads");
+      dStart = Bench_wallMs();
+      for(i = 0; i < 10; i++) {
+         pcString = FT_toString();
+         Bench_require(pcString != NULL &&
+                       strcmp(pcString, pcSerial) == 0, "FT_toString");
+         free(pcString);
+      }
+      printf("tostring %7s %lu thread%s %8.3f ms wall\n", "",
+             (unsigned long) ulThreads, ulThreads == 1 ? " " : "s",
+             (Bench_wallMs() - dStart) / 10);
+   }
+   free(pcSerial);
+   Bench_require(FT_destroy() == SUCCESS, "FT_destroy");
+}
+
+/* Inserts ulFiles files spread over directories whose names repeat
+   the way a source tree's do, then reports the intern table's hit
+   rate and the bytes it saved while that tree is alive. */
+static void Bench_intern(size_t ulFiles) {
+   static const char *apcDirs[] = { "src", "include", "lib", "test",
+                                    "node_modules", "dist" };
+   enum { DIR_COUNT = sizeof(apcDirs) / sizeof(apcDirs[0]) };
+   char acPath[256];
+   struct Intern_Stats sBefore, sStats;
+   size_t i;
+
+   Intern_getStats(&sBefore);
+   Bench_require(FT_init() == SUCCESS, "FT_init");
+   for(i = 0; i < ulFiles; i++) {
+      sprintf(acPath, "root/%s/pkg%lu/%s/%s/file%lu",
+              apcDirs[i % DIR_COUNT], (unsigned long) (i / 7 % 50),
+              apcDirs[i / 3 % DIR_COUNT], apcDirs[i / 5 % DIR_COUNT],
+              (unsigned long) (i % 100));
+      (void) FT_insertFile(acPath, NULL, 0);
+   }
+
+   /* the table is shared with earlier benchmarks: count only this
+      one's lookups */
+   Intern_getStats(&sStats);
+   sStats.ulLookups -= sBefore.ulLookups;
+   sStats.ulHits -= sBefore.ulHits;
+   printf("intern  %lu lookups  %5.1f%% hits  %lu strings  "
+          "%lu bytes stored  %lu bytes saved\n",
+          (unsigned long) sStats.ulLookups,
+          100.0 * (double) sStats.ulHits / (double) sStats.ulLookups,
+          (unsigned long) sStats.ulEntries,
+          (unsigned long) sStats.ulBytesStored,
+          (unsigned long) sStats.ulBytesSaved);
+
+   Bench_require(FT_destroy() == SUCCESS, "FT_destroy");
+}
+
+/* Runs the FT benchmarks, printing one line per measurement to
+   stdout. Build with NDEBUG so that the checker does not dominate
+   the timings. Returns 0. */
+int main(void) {
+   /* directory sizes for Bench_fanout, around the hash index's
+      threshold and well beyond it */
+   static const size_t aulFanouts[] = { 4, 16, 100, 1000, 100000 };
+   size_t i, ulKind;
+
+   Bench_lookup(4, 400000, FALSE);
+   Bench_lookup(16, 100000, FALSE);
+   Bench_lookup(64, 25000, FALSE);
+   Bench_lookup(4, 400000, TRUE);
+   Bench_lookup(16, 100000, TRUE);
+   Bench_lookup(64, 25000, TRUE);
+   Bench_insert(20, 20000);
+   Bench_path("home/user/src", 1000000);
+   Bench_path("usr/local/lib/node_modules/npm/lib/utils/config.js",
+              500000);
+   Bench_pathMix(1000000);
+   Bench_compare("usr/local/lib/node_modules/npm/lib/utils/config.js",
+                 "usr/local/lib/node_modules/npm/lib/utils/config.js",
+                 10000000);
+   Bench_compare("usr/local/lib/node_modules/npm/lib/utils/config.js",
+                 "usr/local/lib/node_modules/npm/lib/utils/config.ts",
+                 10000000);
+   Bench_batch(500000);
+   Bench_siblings(1000000);
+   for(i = 0; i < sizeof(aulFanouts) / sizeof(aulFanouts[0]); i++)
+      for(ulKind = 0; ulKind < INDEX_KINDS; ulKind++)
+         Bench_fanout(ulKind, aulFanouts[i], 2000000);
+   Bench_misses(0, 100000, 2000000);
+   Bench_misses(0.01, 100000, 2000000);
+   Bench_misses(0.001, 100000, 2000000);
+   Bench_listing(4, 100, 100, FALSE);
+   Bench_listing(4, 100, 100, TRUE);
+   Bench_listing(16, 100, 100, FALSE);
+   Bench_listing(16, 100, 100, TRUE);
+   Bench_churn(10000, 20);
+   Bench_teardown(1000000, FALSE, FALSE);
+   Bench_teardown(1000000, TRUE, FALSE);
+   Bench_teardown(1000000, TRUE, TRUE);
+   Bench_rmDir(1000000);
+   Bench_rmFile(1000000);
+   Bench_toString(100, 20);
+   Bench_toString(2000, 150);
+   Bench_intern(100000);
+
+   return 0;
+}
@@ -0,0 +1,284 @@
+/*--------------------------------------------------------------------*/
+/* ft_fuzz.c                                                          */
+/* Author: Zara Hommez                                                */
+/*--------------------------------------------------------------------*/
+
+/*
+  A differential check of the FT_*N entry points. A random sequence of
+  operations is run once through the '\0'-terminated functions and
+  once, from the same seed, through their N variants, with every path
+  handed over in one of three ways: in a heap block of exactly its
+  length, with no terminator; followed, within the range, by a '\0'
+  and stray bytes; or inside a larger buffer whose bytes past the
+  range would change the path if they were read. Each operation's
+  result, and the FT_toString output every SNAPSHOT_EVERY operations,
+  must come out the same both times. Built with the address
+  sanitizer, an over-read of a path is reported where it happens.
+*/
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "ft.h"
+
+/* The default number of seeds, and the operations run for each */
+enum { DEFAULT_SEEDS = 12, OPS = 6000 };
+
+/* How often the whole tree is compared, in operations */
+enum { SNAPSHOT_EVERY = 500, SNAPSHOTS = OPS / SNAPSHOT_EVERY };
+
+/* The operations, each drawn as often as its count of places in
+   aeOpMix */
+enum fuzzOp { OP_INSERT_DIR, OP_INSERT_FILE, OP_RM_DIR, OP_RM_FILE,
+              OP_CONTAINS_DIR, OP_CONTAINS_FILE, OP_GET_CONTENTS,
+              OP_REPLACE_CONTENTS, OP_STAT };
+static const enum fuzzOp aeOpMix[] = {
+   OP_INSERT_DIR, OP_INSERT_DIR, OP_INSERT_FILE, OP_INSERT_FILE,
+   OP_INSERT_FILE, OP_RM_DIR, OP_RM_FILE, OP_CONTAINS_DIR,
+   OP_CONTAINS_FILE, OP_GET_CONTENTS, OP_REPLACE_CONTENTS, OP_STAT
+};
+enum { OP_MIX = sizeof(aeOpMix) / sizeof(aeOpMix[0]) };
+
+/* Paths that are not well formed, and the components well formed ones
+   are built from */
+static const char *apcMalformed[] = { "", "/r", "r/", "r//a", "r/a/" };
+enum { MALFORMED = sizeof(apcMalformed) / sizeof(apcMalformed[0]) };
+static const char *apcComponents[] = { "a", "b", "ab", "a.b", "c" };
+enum { COMPONENTS = sizeof(apcComponents) / sizeof(apcComponents[0]) };
+
+/* File contents are addresses in here, so that both runs give the
+   same ones */
+static char acContents[64];
+
+/* What one operation returned */
+struct result {
+   int iStatus;
+   void *pvContents;
+   boolean bIsFile;
+   size_t ulSize;
+};
+
+/* The state of the pseudo-random sequence, which both runs of a seed
+   must draw from alike */
+static unsigned long ulRandom;
+
+/*--------------------------------------------------------------------*/
+
+/* Exits with an error message naming pcWhat unless bCond holds. */
+static void Fuzz_require(boolean bCond, const char *pcWhat) {
+   if(!bCond) {
+      fprintf(stderr, "ft_fuzz: %s\n", pcWhat);
+      exit(EXIT_FAILURE);
+   }
+}
+
+/* Returns the next pseudo-random number below ulBound. */
+static size_t Fuzz_below(size_t ulBound) {
+   ulRandom = ulRandom * 6364136223846793005UL + 1442695040888963407UL;
+   return (size_t) (ulRandom >> 33) % ulBound;
+}
+
+/* Writes a random path into pcBuf, which has room for 64 bytes: now
+   and then a malformed one or one under another root, but mostly one
+   under "r" of up to five components. */
+static void Fuzz_makePath(char *pcBuf) {
+   size_t ulDepth, i;
+
+   switch(Fuzz_below(20)) {
+      case 0:
+         strcpy(pcBuf, apcMalformed[Fuzz_below(MALFORMED)]);
+         return;
+      case 1:
+         strcpy(pcBuf, "s");
+         break;
+      default:
+         strcpy(pcBuf, "r");
+         break;
+   }
+   ulDepth = Fuzz_below(5);
+   for(i = 0; i < ulDepth; i++) {
+      strcat(pcBuf, "/");
+      strcat(pcBuf, apcComponents[Fuzz_below(COMPONENTS)]);
+   }
+}
+
+/*
+  Returns a new heap block holding pcPath for an N entry point, and
+  sets *pulLength to the length to pass with it. ulHow, from 0 to 2,
+  picks what the block holds: exactly the path's bytes, with no '\0';
+  the path, a '\0' and more bytes, all in the range; or the path
+  followed, outside the range, by more of a path.
+*/
+static char *Fuzz_borrow(const char *pcPath, size_t ulHow,
+                         size_t *pulLength) {
+   static const char acTail[] = "/zz";
+   size_t ulLength = strlen(pcPath);
+   char *pcBlock;
+
+   switch(ulHow) {
+      case 0:
+         /* malloc(0) may return NULL, so an empty path gets a byte */
+         pcBlock = malloc(ulLength == 0 ? 1 : ulLength);
+         Fuzz_require(pcBlock != NULL, "out of memory");
+         memcpy(pcBlock, pcPath, ulLength);
+         *pulLength = ulLength;
+         break;
+      case 1:
+         pcBlock = malloc(ulLength + sizeof(acTail));
+         Fuzz_require(pcBlock != NULL, "out of memory");
+         memcpy(pcBlock, pcPath, ulLength);
+         pcBlock[ulLength] = '\0';
+         memcpy(pcBlock + ulLength + 1, acTail, sizeof(acTail) - 1);
+         *pulLength = ulLength + sizeof(acTail);
+         break;
+      default:
+         pcBlock = malloc(ulLength + sizeof(acTail) - 1);
+         Fuzz_require(pcBlock != NULL, "out of memory");
+         memcpy(pcBlock, pcPath, ulLength);
+         memcpy(pcBlock + ulLength, acTail, sizeof(acTail) - 1);
+         *pulLength = ulLength;
+         break;
+   }
+   return pcBlock;
+}
+
+/* Runs operation eOp on pcPath, through its N variant if bUseN is
+   TRUE, and fills *psResult with what it returned. */
+static void Fuzz_apply(enum fuzzOp eOp, const char *pcPath, boolean bUseN,
+                       struct result *psResult) {
+   /* both runs draw the same numbers, whether they use them or not */
+   void *pvContents = &acContents[Fuzz_below(sizeof(acContents))];
+   size_t ulSize = Fuzz_below(100);
+   size_t ulHow = Fuzz_below(3);
+   char *pcBlock = NULL;
+   size_t ulLength = 0;
+
+   memset(psResult, 0, sizeof(*psResult));
+   if(bUseN)
+      pcBlock = Fuzz_borrow(pcPath, ulHow, &ulLength);
+
+   switch(eOp) {
+      case OP_INSERT_DIR:
+         psResult->iStatus = bUseN ? FT_insertDirN(pcBlock, ulLength) :
+            FT_insertDir(pcPath);
+         break;
+      case OP_INSERT_FILE:
+         psResult->iStatus = bUseN ?
+            FT_insertFileN(pcBlock, ulLength, pvContents, ulSize) :
+            FT_insertFile(pcPath, pvContents, ulSize);
+         break;
+      case OP_RM_DIR:
+         psResult->iStatus = bUseN ? FT_rmDirN(pcBlock, ulLength) :
+            FT_rmDir(pcPath);
+         break;
+      case OP_RM_FILE:
+         psResult->iStatus = bUseN ? FT_rmFileN(pcBlock, ulLength) :
+            FT_rmFile(pcPath);
+         break;
+      case OP_CONTAINS_DIR:
+         psResult->bIsFile = bUseN ? FT_containsDirN(pcBlock, ulLength) :
+            FT_containsDir(pcPath);
+         break;
+      case OP_CONTAINS_FILE:
+         psResult->bIsFile = bUseN ?
+            FT_containsFileN(pcBlock, ulLength) : FT_containsFile(pcPath);
+         break;
+      case OP_GET_CONTENTS:
+         psResult->pvContents = bUseN ?
+            FT_getFileContentsN(pcBlock, ulLength) :
+            FT_getFileContents(pcPath);
+         break;
+      case OP_REPLACE_CONTENTS:
+         psResult->pvContents = bUseN ?
+            FT_replaceFileContentsN(pcBlock, ulLength, pvContents,
+                                    ulSize) :
+            FT_replaceFileContents(pcPath, pvContents, ulSize);
+         break;
+      case OP_STAT:
+         psResult->iStatus = bUseN ?
+            FT_statN(pcBlock, ulLength, &psResult->bIsFile,
+                     &psResult->ulSize) :
+            FT_stat(pcPath, &psResult->bIsFile, &psResult->ulSize);
+         break;
+   }
+   free(pcBlock);
+}
+
+/* Returns TRUE if psFirst and psSecond record the same result. */
+static boolean Fuzz_sameResult(const struct result *psFirst,
+                               const struct result *psSecond) {
+   return psFirst->iStatus == psSecond->iStatus &&
+      psFirst->pvContents == psSecond->pvContents &&
+      psFirst->bIsFile == psSecond->bIsFile &&
+      psFirst->ulSize == psSecond->ulSize;
+}
+
+/* Runs seed ulSeed's operations on a new FT, through the N variants if
+   bUseN is TRUE, filling psResults with every result and ppcSnapshots
+   with the FT's representations along the way. */
+static void Fuzz_run(unsigned long ulSeed, boolean bUseN,
+                     struct result *psResults, char **ppcSnapshots) {
+   char acPath[64];
+   size_t ulOp;
+
+   Fuzz_require(FT_initWithIndex((enum FT_ChildIndex) (ulSeed % 3)) ==
+                SUCCESS, "FT_initWithIndex failed");
+   ulRandom = ulSeed;
+   for(ulOp = 0; ulOp < OPS; ulOp++) {
+      enum fuzzOp eOp = aeOpMix[Fuzz_below(OP_MIX)];
+
+      Fuzz_makePath(acPath);
+      Fuzz_apply(eOp, acPath, bUseN, &psResults[ulOp]);
+      if((ulOp + 1) % SNAPSHOT_EVERY == 0) {
+         ppcSnapshots[ulOp / SNAPSHOT_EVERY] = FT_toString();
+         Fuzz_require(ppcSnapshots[ulOp / SNAPSHOT_EVERY] != NULL,
+                      "FT_toString failed");
+      }
+   }
+   Fuzz_require(FT_destroy() == SUCCESS, "FT_destroy failed");
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Runs the number of seeds given as the only argument, or
+   DEFAULT_SEEDS, and reports the first difference between the two
+   runs of any. Returns 0 if there was none, and exits with
+   EXIT_FAILURE otherwise. */
+int main(int argc, char *argv[]) {
+   static struct result asPlain[OPS], asWithN[OPS];
+   char *apcPlain[SNAPSHOTS], *apcWithN[SNAPSHOTS];
+   unsigned long ulSeeds = DEFAULT_SEEDS, ulSeed;
+   size_t ulDiffers = OPS, ulTreeDiffers = SNAPSHOTS, i;
+
+   if(argc > 1)
+      ulSeeds = strtoul(argv[1], NULL, 10);
+
+   for(ulSeed = 1; ulSeed <= ulSeeds; ulSeed++) {
+      Fuzz_run(ulSeed, FALSE, asPlain, apcPlain);
+      Fuzz_run(ulSeed, TRUE, asWithN, apcWithN);
+      for(i = OPS; i > 0; i--)
+         if(!Fuzz_sameResult(&asPlain[i - 1], &asWithN[i - 1]))
+            ulDiffers = i - 1;
+      for(i = SNAPSHOTS; i > 0; i--) {
+         if(strcmp(apcPlain[i - 1], apcWithN[i - 1]) != 0)
+            ulTreeDiffers = i - 1;
+         free(apcPlain[i - 1]);
+         free(apcWithN[i - 1]);
+      }
+
+      if(ulDiffers != OPS) {
+         fprintf(stderr, "ft_fuzz: seed %lu, operation %lu differs\n",
+                 ulSeed, (unsigned long) ulDiffers);
+         return EXIT_FAILURE;
+      }
+      if(ulTreeDiffers != SNAPSHOTS) {
+         fprintf(stderr, "ft_fuzz: seed %lu, tree after operation %lu "
+                 "differs\n", ulSeed,
+                 (unsigned long) ((ulTreeDiffers + 1) * SNAPSHOT_EVERY));
+         return EXIT_FAILURE;
+      }
+   }
+   printf("ft_fuzz: %lu seeds of %d operations agree\n", ulSeeds, OPS);
+   return 0;
+}
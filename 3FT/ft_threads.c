@@ -0,0 +1,195 @@
+/*--------------------------------------------------------------------*/
+/* ft_threads.c                                                       */
+/* Author: Zara Hommez                                                */
+/*--------------------------------------------------------------------*/
+
+/*
+  A check that FT_toString and FT_write give the same bytes with any
+  number of threads as with one. Trees of several shapes, each built
+  with every kind of child index, are serialized with one thread and
+  then with every count from 2 to MAX_THREADS, and each result is
+  compared with the serial one. Built with the thread sanitizer, or
+  with the address and undefined behavior sanitizers, a race or a bad
+  access in the parallel writer is reported where it happens.
+*/
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "ft.h"
+#include "sink.h"
+
+/* The most threads the serializations are run with */
+enum { MAX_THREADS = 17 };
+
+/* The kinds of child index each shape is built with */
+static const enum FT_ChildIndex aeIndexes[] =
+   { FT_INDEX_SORTED, FT_INDEX_HASH, FT_INDEX_ART };
+enum { INDEX_KINDS = sizeof(aeIndexes) / sizeof(aeIndexes[0]) };
+
+/*--------------------------------------------------------------------*/
+
+/* Exits with an error message naming pcWhat unless bCond holds. */
+static void Threads_require(boolean bCond, const char *pcWhat) {
+   if(!bCond) {
+      fprintf(stderr, "ft_threads: %s\n", pcWhat);
+      exit(EXIT_FAILURE);
+   }
+}
+
+/* Inserts a file at pcPath, which must be new. */
+static void Threads_insertFile(const char *pcPath) {
+   Threads_require(FT_insertFile(pcPath, NULL, 0) == SUCCESS,
+                   "FT_insertFile failed");
+}
+
+/* Leaves the FT empty. */
+static void Threads_buildEmpty(void) {
+}
+
+/* Builds a root directory holding one file. */
+static void Threads_buildSmall(void) {
+   Threads_insertFile("r/f");
+}
+
+/* Builds a root with thousands of subdirectories and as many files,
+   so that the pieces are whole subtrees and runs of them. */
+static void Threads_buildWide(void) {
+   char acPath[64];
+   unsigned long i;
+
+   for(i = 0; i < 6000; i++) {
+      sprintf(acPath, "r/d%05lu/x/f%lu", i, i % 7);
+      Threads_insertFile(acPath);
+      sprintf(acPath, "r/f%lu", i);
+      Threads_insertFile(acPath);
+   }
+}
+
+/* Builds a chain of 1000 directories with 20000 children, files and
+   directories mixed, at its end, so that the pieces are ranges of one
+   directory's children deep in the tree. */
+static void Threads_buildChain(void) {
+   static char acPath[4096];
+   size_t ulLength;
+   unsigned long i;
+
+   strcpy(acPath, "r");
+   for(i = 0; i < 1000; i++) {
+      strcat(acPath, "/c");
+      Threads_require(FT_insertDir(acPath) == SUCCESS,
+                      "FT_insertDir failed");
+   }
+   ulLength = strlen(acPath);
+   for(i = 0; i < 20000; i++) {
+      sprintf(acPath + ulLength, "/%c%lu", i % 3 ? 'f' : 'g', i);
+      if(i % 3)
+         Threads_insertFile(acPath);
+      else
+         Threads_require(FT_insertDir(acPath) == SUCCESS,
+                         "FT_insertDir failed");
+   }
+}
+
+/* Builds a tree of random paths of up to six components, many of
+   them failing to insert, so that its shape follows no pattern. */
+static void Threads_buildMixed(void) {
+   char acPath[64];
+   size_t ulDepth, i, j;
+
+   srand(1);
+   for(i = 0; i < 40000; i++) {
+      strcpy(acPath, "r");
+      ulDepth = 1 + (size_t) rand() % 6;
+      for(j = 0; j < ulDepth; j++)
+         sprintf(acPath + strlen(acPath), "/%c%d", 'a' + rand() % 4,
+                 rand() % 3);
+      if(rand() % 2)
+         (void) FT_insertFile(acPath, NULL, 0);
+      else
+         (void) FT_insertDir(acPath);
+   }
+}
+
+/* The shapes of tree checked, and their names */
+static const struct shape {
+   const char *pcName;
+   void (*pfBuild)(void);
+} asShapes[] = {
+   { "empty", Threads_buildEmpty },
+   { "small", Threads_buildSmall },
+   { "wide", Threads_buildWide },
+   { "chain", Threads_buildChain },
+   { "mixed", Threads_buildMixed }
+};
+enum { SHAPES = sizeof(asShapes) / sizeof(asShapes[0]) };
+
+/* Returns what FT_write writes to a buffer sink, as a new string. */
+static char *Threads_write(void) {
+   Sink_T oSSink;
+   char *pcResult;
+
+   oSSink = Sink_newBuffer();
+   Threads_require(oSSink != NULL, "Sink_newBuffer failed");
+   Threads_require(FT_write(oSSink) == SUCCESS, "FT_write failed");
+   pcResult = Sink_takeString(oSSink);
+   Threads_require(pcResult != NULL, "Sink_takeString failed");
+   Sink_free(oSSink);
+   return pcResult;
+}
+
+/* Serializes the FT, built as shape pcShape, with one thread and then
+   with 2 to MAX_THREADS, and exits with an error message if any
+   result differs from the first. */
+static void Threads_check(const char *pcShape) {
+   char *pcSerial, *pcResult;
+   size_t ulThreads;
+
+   Threads_require(FT_setThreads(1) == SUCCESS, "FT_setThreads failed");
+   pcSerial = FT_toString();
+   Threads_require(pcSerial != NULL, "FT_toString failed");
+
+   for(ulThreads = 2; ulThreads <= MAX_THREADS; ulThreads++) {
+      Threads_require(FT_setThreads(ulThreads) == SUCCESS,
+                      "FT_setThreads failed");
+      pcResult = FT_toString();
+      Threads_require(pcResult != NULL, "FT_toString failed");
+      if(strcmp(pcResult, pcSerial) != 0) {
+         fprintf(stderr, "ft_threads: %s tree, FT_toString with %lu "
+                 "threads differs\n", pcShape, (unsigned long) ulThreads);
+         exit(EXIT_FAILURE);
+      }
+      free(pcResult);
+
+      pcResult = Threads_write();
+      if(strcmp(pcResult, pcSerial) != 0) {
+         fprintf(stderr, "ft_threads: %s tree, FT_write with %lu "
+                 "threads differs\n", pcShape, (unsigned long) ulThreads);
+         exit(EXIT_FAILURE);
+      }
+      free(pcResult);
+   }
+   free(pcSerial);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Checks every shape of tree with every kind of child index. Returns
+   0 if every parallel serialization matched the serial one, and exits
+   with EXIT_FAILURE otherwise. */
+int main(void) {
+   size_t ulKind, ulShape;
+
+   for(ulKind = 0; ulKind < INDEX_KINDS; ulKind++)
+      for(ulShape = 0; ulShape < SHAPES; ulShape++) {
+         Threads_require(FT_initWithIndex(aeIndexes[ulKind]) == SUCCESS,
+                         "FT_initWithIndex failed");
+         (*asShapes[ulShape].pfBuild)();
+         Threads_check(asShapes[ulShape].pcName);
+         Threads_require(FT_destroy() == SUCCESS, "FT_destroy failed");
+      }
+   printf("ft_threads: %d trees agree with 1 to %d threads\n",
+          INDEX_KINDS * SHAPES, MAX_THREADS);
+   return 0;
+}
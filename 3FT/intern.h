@@ -0,0 +1 @@
+../0shared/intern.h
\ No newline at end of file
@@ -7,17 +7,79 @@
 #include <assert.h>
 #include <string.h>
 
-#include "dynarray.h"
+#include "art.h"
+#include "chunkarray.h"
+#include "intern.h"
 #include "nodeFT.h"
+#include "region.h"
+#include "slab.h"
 #include "checkerFT.h"
 
+/* The fanout at which a directory gains a hash index over its
+   children's names; the index is dropped again once fanout falls
+   below half of this */
+enum { CHILD_INDEX_THRESHOLD = 64 };
+
+/* The kind of child index kept by directories, as set by
+   Node_setChildIndex */
+static enum Node_ChildIndex eChildIndex = NODE_INDEX_HASH;
+
+/* The slab every struct node comes from, made with the first node
+   after Node_freeSlabs, or ever, and freed with its pages by the next
+   Node_freeSlabs */
+static Slab_T oSNodes;
+
+/* The region, set by Node_setRegion, that nodes and everything they
+   own come from instead of the slab and malloc, or NULL */
+static Region_T oRNodes;
+
+/* While oRNodes is set, nodes hold no references to their names:
+   instead this table, an open-addressing (linear probing) set kept at
+   most half full, holds one reference to each distinct name any node
+   in the region has had, so the region can be discarded without
+   visiting its nodes. Its number of slots is a power of 2, or 0. */
+static const char **ppcHeldNames;
+static size_t ulHeldSlots;
+static size_t ulHeldNames;
+
+/* One slot of a directory's child hash index */
+struct childSlot {
+   /* Intern_hash of the child's name, checked before the name is */
+   unsigned long long ullHash;
+   /* the child, or NULL if this slot is empty */
+   Node_T oNChild;
+};
+
 struct node {
-    /* the object corresponding to the node's absolute path */
-   Path_T oPPath;
+   /* this node's own path component, an interned string this node
+      holds a reference to; the key this node is sorted and searched
+      by among its siblings. The absolute path is never stored: it is
+      rebuilt from the chain of parents when needed. */
+   const char *pcName;
+   /* the number of components in this node's absolute path */
+   size_t ulDepth;
    /* this node's parent */
    Node_T oNParent;
-   /* the object containing links to this node's children */
-   DynArray_T oDChildren;
+   /* the chunk of the one of oNParent's children arrays this node is
+      in, as that array last reported; lets Node_free unlink this node
+      without searching for it */
+   void *pvChunk;
+   /* the objects containing links to this node's files and to its
+      subdirectories, each sorted by name; chunked so that huge
+      directories insert in sublinear time. Kept apart so that the
+      files, which FT_toString lists first, have the first child
+      identifiers and the subdirectories the rest. */
+   ChunkArray_T oCFiles;
+   ChunkArray_T oCDirs;
+   /* an open-addressing (linear probing) hash table of the same
+      children keyed by name, kept at most half full, or NULL while
+      fanout is below CHILD_INDEX_THRESHOLD */
+   struct childSlot *psSlots;
+   /* the number of slots in psSlots less one; a power of 2 less one */
+   size_t ulSlotMask;
+   /* with NODE_INDEX_ART, an adaptive radix tree of the same children
+      keyed by name, or NULL while there are none */
+   Art_T oAIndex;
    /* boolean to store if file (true) or directory (false)*/
    boolean bIsFile;
    /* pointer to the contents of file (null if directory)*/
@@ -26,9 +88,372 @@ struct node {
    size_t ulContentLength;
 };
 
-/* Links new child oNChild into oNParent's children array at index
-   ulIndex. Returns SUCCESS if the new child was added successfully,
-   or MEMORY_ERROR if allocation fails. */
+/* Records that pvChild is now in chunk pvChunk of one of its parent's
+   children arrays; the tracker of every directory's oCFiles and
+   oCDirs. */
+static void Node_placeChild(void *pvChild, void *pvChunk) {
+   assert(pvChild != NULL);
+
+   ((Node_T) pvChild)->pvChunk = pvChunk;
+}
+
+/* Returns the array of directory oNParent's children that holds its
+   files if bIsFile is TRUE, or its subdirectories if it is FALSE. */
+static ChunkArray_T Node_childrenOf(Node_T oNParent, boolean bIsFile) {
+   assert(oNParent != NULL);
+   assert(!oNParent->bIsFile);
+
+   return bIsFile ? oNParent->oCFiles : oNParent->oCDirs;
+}
+
+/* Returns the child of directory oNParent with identifier ulChildID,
+   which must be valid: its files come first, then its
+   subdirectories. */
+static Node_T Node_childAt(Node_T oNParent, size_t ulChildID) {
+   size_t ulFiles;
+
+   assert(oNParent != NULL);
+   assert(!oNParent->bIsFile);
+
+   ulFiles = ChunkArray_getLength(oNParent->oCFiles);
+   if(ulChildID < ulFiles)
+      return ChunkArray_get(oNParent->oCFiles, ulChildID);
+   return ChunkArray_get(oNParent->oCDirs, ulChildID - ulFiles);
+}
+
+/* Returns pcName, an interned string, after making sure that a
+   reference to it is held for a new node: the node's own reference,
+   or, while nodes come from a region, the held names table's. Returns
+   NULL if memory could not be allocated. */
+static const char *Node_holdName(const char *pcName) {
+   size_t ulSlot;
+
+   assert(pcName != NULL);
+
+   if(oRNodes == NULL)
+      return Intern_retain(pcName);
+
+   if(2 * (ulHeldNames + 1) > ulHeldSlots) {
+      size_t ulNewSlots = ulHeldSlots == 0 ? 64 : 2 * ulHeldSlots;
+      const char **ppcNew = calloc(ulNewSlots, sizeof(const char *));
+      size_t i;
+
+      if(ppcNew == NULL)
+         return NULL;
+      for(i = 0; i < ulHeldSlots; i++) {
+         if(ppcHeldNames[i] == NULL)
+            continue;
+         for(ulSlot = (size_t) Intern_getHash(ppcHeldNames[i]) &
+                (ulNewSlots - 1);
+             ppcNew[ulSlot] != NULL;
+             ulSlot = (ulSlot + 1) & (ulNewSlots - 1))
+            ;
+         ppcNew[ulSlot] = ppcHeldNames[i];
+      }
+      free(ppcHeldNames);
+      ppcHeldNames = ppcNew;
+      ulHeldSlots = ulNewSlots;
+   }
+
+   for(ulSlot = (size_t) Intern_getHash(pcName) & (ulHeldSlots - 1);
+       ppcHeldNames[ulSlot] != NULL;
+       ulSlot = (ulSlot + 1) & (ulHeldSlots - 1))
+      if(ppcHeldNames[ulSlot] == pcName)
+         return pcName;
+   ppcHeldNames[ulSlot] = Intern_retain(pcName);
+   ulHeldNames++;
+   return pcName;
+}
+
+/* Drops the reference to pcName that Node_holdName took for a node
+   that is being freed, unless the held names table holds it. */
+static void Node_dropName(const char *pcName) {
+   if(oRNodes == NULL)
+      Intern_release(pcName);
+}
+
+/* Returns a new, uninitialized node from the region, if set, or the
+   slab, or NULL if memory could not be allocated. */
+static struct node *Node_allocNode(void) {
+   if(oRNodes != NULL)
+      return Region_alloc(oRNodes, sizeof(struct node));
+   if(oSNodes == NULL) {
+      oSNodes = Slab_new(sizeof(struct node));
+      if(oSNodes == NULL)
+         return NULL;
+   }
+   return Slab_alloc(oSNodes);
+}
+
+/* Returns psNode, which Node_allocNode gave out, to where it came
+   from. */
+static void Node_releaseNode(struct node *psNode) {
+   assert(psNode != NULL);
+
+   if(oRNodes != NULL)
+      Region_release(oRNodes, psNode, sizeof(struct node));
+   else
+      Slab_release(oSNodes, psNode);
+}
+
+/* Frees oNParent's child hash index, if it has one. */
+static void Node_freeSlots(Node_T oNParent) {
+   assert(oNParent != NULL);
+
+   if(oNParent->psSlots == NULL)
+      return;
+   Region_release(oRNodes, oNParent->psSlots,
+                  (oNParent->ulSlotMask + 1) * sizeof(struct childSlot));
+   oNParent->psSlots = NULL;
+   oNParent->ulSlotMask = 0;
+}
+
+/* Stores oNChild, whose name hashes to ullHash, in the first empty
+   slot of its probe sequence in psSlots. */
+static void Node_indexPut(struct childSlot *psSlots, size_t ulSlotMask,
+                          unsigned long long ullHash, Node_T oNChild) {
+   size_t ulSlot;
+
+   assert(psSlots != NULL);
+   assert(oNChild != NULL);
+
+   for(ulSlot = (size_t) ullHash & ulSlotMask;
+       psSlots[ulSlot].oNChild != NULL;
+       ulSlot = (ulSlot + 1) & ulSlotMask)
+      ;
+   psSlots[ulSlot].ullHash = ullHash;
+   psSlots[ulSlot].oNChild = oNChild;
+}
+
+/* Replaces oNParent's child hash index, if any, by one of ulSlots slots
+   holding every current child. ulSlots must be a power of 2. Leaves
+   oNParent without an index if memory could not be allocated: the
+   index only speeds up lookups, so that is not an error. */
+static void Node_hashRebuild(Node_T oNParent, size_t ulSlots) {
+   struct childSlot *psSlots;
+   size_t ulChildren;
+   size_t i;
+
+   assert(oNParent != NULL);
+
+   Node_freeSlots(oNParent);
+
+   psSlots = Region_alloc(oRNodes, ulSlots * sizeof(struct childSlot));
+   if(psSlots == NULL)
+      return;
+   memset(psSlots, 0, ulSlots * sizeof(struct childSlot));
+   ulChildren = Node_getNumChildren(oNParent);
+   for(i = 0; i < ulChildren; i++) {
+      Node_T oNChild = Node_childAt(oNParent, i);
+      Node_indexPut(psSlots, ulSlots - 1, Intern_getHash(oNChild->pcName),
+                    oNChild);
+   }
+   oNParent->psSlots = psSlots;
+   oNParent->ulSlotMask = ulSlots - 1;
+}
+
+/* Brings oNParent's child hash index up to date after oNChild was
+   added to its children, creating or growing it as fanout requires. */
+static void Node_hashAdd(Node_T oNParent, Node_T oNChild) {
+   size_t ulChildren;
+   size_t ulSlots;
+
+   assert(oNParent != NULL);
+   assert(oNChild != NULL);
+
+   ulChildren = Node_getNumChildren(oNParent);
+   if(oNParent->psSlots != NULL && 2 * ulChildren <= oNParent->ulSlotMask)
+      Node_indexPut(oNParent->psSlots, oNParent->ulSlotMask,
+                    Intern_getHash(oNChild->pcName), oNChild);
+   else if(ulChildren >= CHILD_INDEX_THRESHOLD) {
+      /* room for twice as many children again, at most half full */
+      for(ulSlots = 1; ulSlots < 4 * ulChildren; ulSlots *= 2)
+         ;
+      Node_hashRebuild(oNParent, ulSlots);
+   }
+}
+
+/* Brings oNParent's child hash index up to date after oNChild was
+   removed from its children. */
+static void Node_hashRemove(Node_T oNParent, Node_T oNChild) {
+   struct childSlot *psSlots;
+   size_t ulMask;
+   size_t ulHole, ulSlot;
+
+   assert(oNParent != NULL);
+   assert(oNChild != NULL);
+
+   psSlots = oNParent->psSlots;
+   ulMask = oNParent->ulSlotMask;
+   if(psSlots == NULL)
+      return;
+   if(Node_getNumChildren(oNParent) < CHILD_INDEX_THRESHOLD / 2) {
+      Node_freeSlots(oNParent);
+      return;
+   }
+
+   ulHole = (size_t) Intern_getHash(oNChild->pcName) & ulMask;
+   while(psSlots[ulHole].oNChild != oNChild)
+      ulHole = (ulHole + 1) & ulMask;
+
+   /* close the hole by moving back any later entry of the same run
+      that may no longer be reachable from its home slot */
+   for(ulSlot = (ulHole + 1) & ulMask; psSlots[ulSlot].oNChild != NULL;
+       ulSlot = (ulSlot + 1) & ulMask) {
+      size_t ulHome = (size_t) psSlots[ulSlot].ullHash & ulMask;
+      if(((ulSlot - ulHome) & ulMask) >= ((ulSlot - ulHole) & ulMask)) {
+         psSlots[ulHole] = psSlots[ulSlot];
+         ulHole = ulSlot;
+      }
+   }
+   psSlots[ulHole].oNChild = NULL;
+}
+
+/* Compares the ulFirstLength bytes at pcFirst with the ulSecondLength
+   bytes at pcSecond lexicographically, as strcmp would if both were
+   '\0'-terminated component names. */
+static int Node_compareNames(const char *pcFirst, size_t ulFirstLength,
+                             const char *pcSecond, size_t ulSecondLength) {
+   int iCmp;
+
+   assert(pcFirst != NULL);
+   assert(pcSecond != NULL);
+
+   if(ulFirstLength < ulSecondLength)
+      iCmp = memcmp(pcFirst, pcSecond, ulFirstLength);
+   else
+      iCmp = memcmp(pcFirst, pcSecond, ulSecondLength);
+   if(iCmp != 0)
+      return iCmp;
+   /* one name is a prefix of the other: the shorter sorts first */
+   if(ulFirstLength < ulSecondLength)
+      return -1;
+   return ulFirstLength > ulSecondLength;
+}
+
+#ifndef NDEBUG
+/* The progress of checking a directory's child radix tree against
+   its children */
+struct artCheck {
+   /* the directory */
+   Node_T oNParent;
+   /* the value visited last, or NULL before the first */
+   Node_T oNLast;
+   /* the number of values visited */
+   size_t ulVisited;
+   /* FALSE once a value was visited out of order or was not a child */
+   boolean bOrdered;
+};
+
+/* Checks that pvChild is a child of psCheck's directory named after
+   the child visited before it. */
+static void Node_artCheckChild(void *pvChild, void *pvCheck) {
+   struct artCheck *psCheck = pvCheck;
+   Node_T oNChild = pvChild;
+
+   if(oNChild->oNParent != psCheck->oNParent ||
+      (psCheck->oNLast != NULL &&
+       Node_compareNames(psCheck->oNLast->pcName,
+                         Intern_getLength(psCheck->oNLast->pcName),
+                         oNChild->pcName,
+                         Intern_getLength(oNChild->pcName)) >= 0))
+      psCheck->bOrdered = FALSE;
+   psCheck->oNLast = oNChild;
+   psCheck->ulVisited++;
+}
+
+/* Returns TRUE if oNParent's child radix tree, if it has one, holds
+   exactly its children and visits them in order of name. */
+static boolean Node_artIsValid(Node_T oNParent) {
+   struct artCheck sCheck;
+
+   if(oNParent->oAIndex == NULL)
+      return TRUE;
+   sCheck.oNParent = oNParent;
+   sCheck.oNLast = NULL;
+   sCheck.ulVisited = 0;
+   sCheck.bOrdered = TRUE;
+   Art_map(oNParent->oAIndex, Node_artCheckChild, &sCheck);
+   return sCheck.bOrdered &&
+      sCheck.ulVisited == Node_getNumChildren(oNParent);
+}
+#endif
+
+/* Brings oNParent's child radix tree up to date after oNChild was
+   added to its children. A tree that could not be kept complete is
+   dropped, to be rebuilt from every child on the next addition. */
+static void Node_artAdd(Node_T oNParent, Node_T oNChild) {
+   size_t ulChildren;
+   size_t i;
+
+   assert(oNParent != NULL);
+   assert(oNChild != NULL);
+
+   if(oNParent->oAIndex != NULL) {
+      if(Art_put(oNParent->oAIndex, oNChild->pcName,
+                 Intern_getLength(oNChild->pcName), oNChild)) {
+         assert(Node_artIsValid(oNParent));
+         return;
+      }
+      Art_free(oNParent->oAIndex);
+      oNParent->oAIndex = NULL;
+      return;
+   }
+
+   oNParent->oAIndex = Art_newIn(oRNodes);
+   if(oNParent->oAIndex == NULL)
+      return;
+   ulChildren = Node_getNumChildren(oNParent);
+   for(i = 0; i < ulChildren; i++) {
+      Node_T oNOther = Node_childAt(oNParent, i);
+      if(!Art_put(oNParent->oAIndex, oNOther->pcName,
+                  Intern_getLength(oNOther->pcName), oNOther)) {
+         Art_free(oNParent->oAIndex);
+         oNParent->oAIndex = NULL;
+         return;
+      }
+   }
+   assert(Node_artIsValid(oNParent));
+}
+
+/* Brings oNParent's child radix tree up to date after oNChild was
+   removed from its children, freeing it once it is empty. */
+static void Node_artRemove(Node_T oNParent, Node_T oNChild) {
+   assert(oNParent != NULL);
+   assert(oNChild != NULL);
+
+   if(oNParent->oAIndex == NULL)
+      return;
+   (void) Art_remove(oNParent->oAIndex, oNChild->pcName,
+                     Intern_getLength(oNChild->pcName));
+   if(Art_getSize(oNParent->oAIndex) == 0) {
+      Art_free(oNParent->oAIndex);
+      oNParent->oAIndex = NULL;
+   }
+   assert(Node_artIsValid(oNParent));
+}
+
+/* Brings oNParent's child index, of the kind eChildIndex selects, up
+   to date after oNChild was added to its children. */
+static void Node_indexAdd(Node_T oNParent, Node_T oNChild) {
+   if(eChildIndex == NODE_INDEX_HASH)
+      Node_hashAdd(oNParent, oNChild);
+   else if(eChildIndex == NODE_INDEX_ART)
+      Node_artAdd(oNParent, oNChild);
+}
+
+/* Brings oNParent's child index, of the kind eChildIndex selects, up
+   to date after oNChild was removed from its children. */
+static void Node_indexRemove(Node_T oNParent, Node_T oNChild) {
+   if(eChildIndex == NODE_INDEX_HASH)
+      Node_hashRemove(oNParent, oNChild);
+   else if(eChildIndex == NODE_INDEX_ART)
+      Node_artRemove(oNParent, oNChild);
+}
+
+/* Links new child oNChild into the array of oNParent's children of
+   its type at index ulIndex. Returns SUCCESS if the new child was
+   added successfully, or MEMORY_ERROR if allocation fails. */
 static int Node_addChild(Node_T oNParent, Node_T oNChild, 
    size_t ulIndex) {
    assert(oNParent != NULL);
@@ -36,131 +461,184 @@ static int Node_addChild(Node_T oNParent, Node_T oNChild,
    /* only directories can have children*/
    assert(!Node_isFile(oNParent));
 
-   if(DynArray_addAt(oNParent->oDChildren, ulIndex, oNChild))
-      return SUCCESS;
-   else
+   if(!ChunkArray_addAt(Node_childrenOf(oNParent, oNChild->bIsFile),
+                        ulIndex, oNChild))
       return MEMORY_ERROR;
+   Node_indexAdd(oNParent, oNChild);
+   return SUCCESS;
 }
 
 
-static int Node_compareString(const Node_T oNFirst,
-   const char *pcSecond) {
+/* A borrowed, length-delimited component name used as a search key
+   among a directory's children */
+struct componentKey {
+   /* the first byte of the name, not necessarily '\0'-terminated */
+   const char *pcName;
+   /* the number of bytes in the name */
+   size_t ulLength;
+};
+
+/* Compares oNFirst's final path component with the name in psKey.
+   Siblings share every other component, so this orders children
+   exactly as comparing their full paths would. */
+static int Node_compareComponent(const Node_T oNFirst,
+   const struct componentKey *psKey) {
    assert(oNFirst != NULL);
-   assert(pcSecond != NULL);
+   assert(psKey != NULL);
+
+   return Node_compareNames(oNFirst->pcName,
+                            Intern_getLength(oNFirst->pcName),
+                            psKey->pcName, psKey->ulLength);
+}
+
+/* Returns TRUE if oCChildren, one of a directory's children arrays,
+   holds a child whose final path component is the ulLength bytes at
+   pcComponent, and FALSE if not. Stores in *pulIndex the child's
+   index in oCChildren, or the index such a child would be inserted
+   at. */
+static boolean Node_searchChildren(ChunkArray_T oCChildren,
+                                   const char *pcComponent,
+                                   size_t ulLength, size_t *pulIndex) {
+   struct componentKey sKey;
+
+   assert(oCChildren != NULL);
+   assert(pcComponent != NULL);
+   assert(pulIndex != NULL);
+
+   sKey.pcName = pcComponent;
+   sKey.ulLength = ulLength;
+   return ChunkArray_bsearch(oCChildren, &sKey, pulIndex,
+            (int (*)(const void*,const void*)) Node_compareComponent);
+}
+
+
+/* Returns TRUE if oNNode's absolute path is a prefix of oPPath (or
+   equal to it), and FALSE otherwise. Compares one component per
+   ancestor, walking up from oNNode. */
+static boolean Node_isPrefixOf(Node_T oNNode, Path_T oPPath) {
+   assert(oNNode != NULL);
+   assert(oPPath != NULL);
 
-   return Path_compareString(oNFirst->oPPath, pcSecond);
+   if(oNNode->ulDepth > Path_getDepth(oPPath))
+      return FALSE;
+
+   /* both sides are interned, so pointers can be compared */
+   for(; oNNode != NULL; oNNode = oNNode->oNParent) {
+      if(oNNode->pcName != Path_getComponent(oPPath, oNNode->ulDepth - 1))
+         return FALSE;
+   }
+   return TRUE;
 }
 
+void Node_setChildIndex(enum Node_ChildIndex eIndex) {
+   assert(eIndex == NODE_INDEX_SORTED || eIndex == NODE_INDEX_HASH ||
+          eIndex == NODE_INDEX_ART);
+
+   eChildIndex = eIndex;
+}
 
 int Node_new(Path_T oPPath, Node_T oNParent, boolean bIsFile,
              void *pvContents, size_t ulLength, Node_T *poNResult) {
    struct node *psNew;
-   Path_T oPParentPath = NULL;
-   Path_T oPNewPath = NULL;
-   size_t ulParentDepth;
+   const char *pcName;
+   size_t ulDepth;
+   size_t ulNameLength;
    size_t ulIndex = 0;
+   size_t ulOtherIndex;
    int iStatus;
 
    assert(oPPath != NULL);
+   assert(poNResult != NULL);
    assert(oNParent == NULL || CheckerFT_Node_isValid(oNParent));
 
-   psNew = malloc(sizeof(struct node));
-   if(psNew == NULL) {
-      *poNResult = NULL;
-      return MEMORY_ERROR;
-   }
-
-   iStatus = Path_dup(oPPath, &oPNewPath);
-   if(iStatus != SUCCESS) {
-      free(psNew);
-      *poNResult = NULL;
-      return iStatus;
-   }
-   psNew->oPPath = oPNewPath;
-
+   *poNResult = NULL;
+   ulDepth = Path_getDepth(oPPath);
+   pcName = Path_getComponent(oPPath, ulDepth - 1);
+   ulNameLength = Intern_getLength(pcName);
 
    if(oNParent != NULL) {
-      size_t ulSharedDepth;
-
       /* verifies that parent is directory*/
-      if(Node_isFile(oNParent)) {
-         Path_free(psNew->oPPath);
-         free(psNew);
-         *poNResult = NULL;
+      if(Node_isFile(oNParent))
          return NOT_A_DIRECTORY;
-      }
-
-      /* already asserted parent isn't null*/
-      oPParentPath = oNParent->oPPath;
-      ulParentDepth = Path_getDepth(oPParentPath);
-      ulSharedDepth = Path_getSharedPrefixDepth(psNew->oPPath,
-                                                oPParentPath);
 
       /* should have a common depth since parent is the 
       prefix of the node*/
-      if(ulSharedDepth < ulParentDepth) {
-         Path_free(psNew->oPPath);
-         free(psNew);
-         *poNResult = NULL;
+      if(!Node_isPrefixOf(oNParent, oPPath))
          return CONFLICTING_PATH;
-      }
 
       /* parent should be direct ancestor(one less) than node*/
-      if(Path_getDepth(psNew->oPPath) != ulParentDepth + 1) {
-         Path_free(psNew->oPPath);
-         free(psNew);
-         *poNResult = NULL;
+      if(ulDepth != oNParent->ulDepth + 1)
          return NO_SUCH_PATH;
-      }
 
-      /* check if this node already exists*/
-      if(Node_hasChild(oNParent, oPPath, &ulIndex)) {
-         Path_free(psNew->oPPath);
-         free(psNew);
-         *poNResult = NULL;
+      /* check if this node already exists, as either type, finding
+         where it goes among the children of its own type */
+      if(Node_searchChildren(Node_childrenOf(oNParent, bIsFile), pcName,
+                             ulNameLength, &ulIndex) ||
+         Node_searchChildren(Node_childrenOf(oNParent, !bIsFile), pcName,
+                             ulNameLength, &ulOtherIndex))
          return ALREADY_IN_TREE;
-      }
-      
-      iStatus = Node_addChild(oNParent, psNew, ulIndex);
-      if(iStatus != SUCCESS) {
-         Path_free(psNew->oPPath);
-         free(psNew);
-         *poNResult = NULL;
-         return iStatus;
-      }
    }
    else {
       /* parent is null, meaning this node needs to be new root*/
-      if(Path_getDepth(psNew->oPPath) != 1 || bIsFile) {
-         Path_free(psNew->oPPath);
-         free(psNew);
-         *poNResult = NULL;
+      if(ulDepth != 1 || bIsFile) {
          if (bIsFile) 
             return CONFLICTING_PATH;
          else 
             return NO_SUCH_PATH;
       }
    }
+
+   psNew = Node_allocNode();
+   if(psNew == NULL)
+      return MEMORY_ERROR;
+   /* share the path's interned component rather than copying it */
+   psNew->pcName = Node_holdName(pcName);
+   if(psNew->pcName == NULL) {
+      Node_releaseNode(psNew);
+      return MEMORY_ERROR;
+   }
+   psNew->ulDepth = ulDepth;
    psNew->oNParent = oNParent;
+   psNew->pvChunk = NULL;
+   psNew->psSlots = NULL;
+   psNew->ulSlotMask = 0;
+   psNew->oAIndex = NULL;
+
    if (bIsFile) { 
-      psNew->oDChildren = NULL;
+      psNew->oCFiles = NULL;
+      psNew->oCDirs = NULL;
       psNew->pvContents = pvContents; 
       psNew->ulContentLength = ulLength;
    }
    else { 
-      psNew->oDChildren = DynArray_new(0);
-      if(psNew->oDChildren == NULL) {
-         Path_free(psNew->oPPath);
-         free(psNew);
-         *poNResult = NULL;
+      psNew->oCFiles = ChunkArray_newIn(oRNodes);
+      psNew->oCDirs = ChunkArray_newIn(oRNodes);
+      if(psNew->oCFiles == NULL || psNew->oCDirs == NULL) {
+         ChunkArray_free(psNew->oCFiles);
+         ChunkArray_free(psNew->oCDirs);
+         Node_dropName(psNew->pcName);
+         Node_releaseNode(psNew);
          return MEMORY_ERROR;
       }
+      ChunkArray_setTracker(psNew->oCFiles, Node_placeChild);
+      ChunkArray_setTracker(psNew->oCDirs, Node_placeChild);
       /* technically this assignment should be the case in
       contents/length handling in FT, but this is more explicit */
       psNew->pvContents = NULL; 
       psNew->ulContentLength = 0; 
    }
    psNew->bIsFile = bIsFile;
+
+   if(oNParent != NULL) {
+      iStatus = Node_addChild(oNParent, psNew, ulIndex);
+      if(iStatus != SUCCESS) {
+         ChunkArray_free(psNew->oCFiles);
+         ChunkArray_free(psNew->oCDirs);
+         Node_dropName(psNew->pcName);
+         Node_releaseNode(psNew);
+         return iStatus;
+      }
+   }
    *poNResult = psNew;
 
    assert(oNParent == NULL || CheckerFT_Node_isValid(oNParent));
@@ -170,42 +648,191 @@ int Node_new(Path_T oPPath, Node_T oNParent, boolean bIsFile,
 }
 
 size_t Node_free(Node_T oNNode) {
-   size_t ulIndex;
+   return Node_freeVisiting(oNNode, NULL, NULL);
+}
+
+size_t Node_freeVisiting(Node_T oNNode,
+                         void (*pfVisit)(Node_T oNNode, boolean bArriving,
+                                         void *pvExtra),
+                         void *pvExtra) {
    size_t ulCount = 0;
+   Node_T oNCurr;
 
    assert(oNNode != NULL);
    assert(CheckerFT_Node_isValid(oNNode));
 
-   /* remove oNNode from children list of parent*/
+   /* remove oNNode from children list of parent: its chunk is known,
+      so it is found by identity there, with no names compared */
    if(oNNode->oNParent != NULL) {
       Node_T oNParent = oNNode->oNParent;
-   
-      if(!Node_isFile(oNParent)) {
-         if(DynArray_bsearch(oNParent->oDChildren, oNNode, &ulIndex,
-                             (int (*)(const void *, const void *))
-                                Node_compare))
-            (void) DynArray_removeAt(oNParent->oDChildren, ulIndex);
-      }
+
+      ChunkArray_removeElement(Node_childrenOf(oNParent, oNNode->bIsFile),
+                               oNNode->pvChunk, oNNode);
+      Node_indexRemove(oNParent, oNNode);
    }
-   /* recursively remove children only of directories*/
-   if(!Node_isFile(oNNode)) {
-      while(DynArray_getLength(oNNode->oDChildren) != 0) {
-         ulCount += Node_free(DynArray_get(oNNode->oDChildren, 0));
+
+   /* free the detached subtree depth first, without recursion: the
+      parent links lead back up, so they serve as the stack. Children
+      are taken off the end of their directory's arrays, which moves
+      nothing, and the arrays and indexes are freed whole once empty,
+      so no child is searched for or unindexed one at a time. */
+   oNCurr = oNNode;
+   if(pfVisit != NULL)
+      (*pfVisit)(oNCurr, TRUE, pvExtra);
+   for(;;) {
+      Node_T oNParent;
+      size_t ulChildren;
+
+      if(!Node_isFile(oNCurr)) {
+         ChunkArray_T oCChildren = oNCurr->oCFiles;
+
+         ulChildren = ChunkArray_getLength(oCChildren);
+         if(ulChildren == 0) {
+            oCChildren = oNCurr->oCDirs;
+            ulChildren = ChunkArray_getLength(oCChildren);
+         }
+         if(ulChildren != 0) {
+            oNCurr = ChunkArray_removeAt(oCChildren, ulChildren - 1);
+            if(pfVisit != NULL)
+               (*pfVisit)(oNCurr, TRUE, pvExtra);
+            continue;
+         }
+         ChunkArray_free(oNCurr->oCFiles);
+         ChunkArray_free(oNCurr->oCDirs);
+         Node_freeSlots(oNCurr);
+         Art_free(oNCurr->oAIndex);
       }
-      DynArray_free(oNNode->oDChildren);
+
+      if(pfVisit != NULL)
+         (*pfVisit)(oNCurr, FALSE, pvExtra);
+      oNParent = oNCurr == oNNode ? NULL : oNCurr->oNParent;
+      Node_dropName(oNCurr->pcName);
+      Node_releaseNode(oNCurr);
+      ulCount++;
+      if(oNParent == NULL)
+         return ulCount;
+      oNCurr = oNParent;
+   }
+}
+
+void Node_setRegion(Region_T oRRegion) {
+   size_t i;
+
+   /* the nodes of a region being left behind no longer need names */
+   for(i = 0; i < ulHeldSlots; i++)
+      Intern_release(ppcHeldNames[i]);
+   free(ppcHeldNames);
+   ppcHeldNames = NULL;
+   ulHeldSlots = 0;
+   ulHeldNames = 0;
+
+   oRNodes = oRRegion;
+}
+
+void Node_getSlabStats(struct Slab_Stats *psStats) {
+   assert(psStats != NULL);
+
+   Slab_getStats(oSNodes, psStats);
+}
+
+void Node_freeSlabs(void) {
+   struct Slab_Stats sStats;
+
+   Slab_getStats(oSNodes, &sStats);
+   if(sStats.ulLive != 0)
+      return;
+   Slab_free(oSNodes);
+   oSNodes = NULL;
+   ChunkArray_freeSlab();
+}
+
+int Node_getPath(Node_T oNNode, Path_T *poPResult) {
+   char *pcPath;
+   int iStatus;
+
+   assert(oNNode != NULL);
+   assert(poPResult != NULL);
+
+   pcPath = Node_toString(oNNode);
+   if(pcPath == NULL) {
+      *poPResult = NULL;
+      return MEMORY_ERROR;
    }
 
-   Path_free(oNNode->oPPath);
-   free(oNNode);
-   ulCount++;
+   iStatus = Path_new(pcPath, poPResult);
+   free(pcPath);
+   return iStatus;
+}
+
+const char *Node_getName(Node_T oNNode) {
+   assert(oNNode != NULL);
+
+   return oNNode->pcName;
+}
+
+size_t Node_getDepth(Node_T oNNode) {
+   assert(oNNode != NULL);
+
+   return oNNode->ulDepth;
+}
+
+size_t Node_getPathLength(Node_T oNNode) {
+   size_t ulLength;
+
+   assert(oNNode != NULL);
+
+   /* one '/' between each pair of components */
+   ulLength = oNNode->ulDepth - 1;
+   for(; oNNode != NULL; oNNode = oNNode->oNParent)
+      ulLength += Intern_getLength(oNNode->pcName);
+   return ulLength;
+}
+
+size_t Node_writePath(Node_T oNNode, char *pcBuf) {
+   size_t ulLength;
+   char *pcInsert;
+
+   assert(oNNode != NULL);
+   assert(pcBuf != NULL);
 
-   return ulCount;
+   /* fill from the end, walking up from oNNode to the root */
+   ulLength = Node_getPathLength(oNNode);
+   pcInsert = pcBuf + ulLength;
+   *pcInsert = '\0';
+   for(;;) {
+      size_t ulNameLength = Intern_getLength(oNNode->pcName);
+
+      pcInsert -= ulNameLength;
+      memcpy(pcInsert, oNNode->pcName, ulNameLength);
+      oNNode = oNNode->oNParent;
+      if(oNNode == NULL)
+         break;
+      *--pcInsert = '/';
+   }
+   return ulLength;
 }
 
-Path_T Node_getPath(Node_T oNNode) {
+boolean Node_matchesPath(Node_T oNNode, const char *pcPath,
+                         size_t ulLength) {
    assert(oNNode != NULL);
+   assert(pcPath != NULL);
 
-   return oNNode->oPPath;
+   /* match names from the end, walking up from oNNode to the root */
+   for(;;) {
+      size_t ulNameLength = Intern_getLength(oNNode->pcName);
+
+      if(ulNameLength > ulLength ||
+         memcmp(pcPath + ulLength - ulNameLength, oNNode->pcName,
+                ulNameLength) != 0)
+         return FALSE;
+      ulLength -= ulNameLength;
+      oNNode = oNNode->oNParent;
+      if(oNNode == NULL)
+         return ulLength == 0;
+      if(ulLength == 0 || pcPath[ulLength - 1] != '/')
+         return FALSE;
+      ulLength--;
+   }
 }
 
 boolean Node_isFile(Node_T oNNode) {
@@ -215,15 +842,88 @@ boolean Node_isFile(Node_T oNNode) {
 }
 
 boolean Node_hasChild(Node_T oNParent, Path_T oPPath, size_t *pulChildID) {
+   size_t ulDepth;
+   const char *pcComponent;
+
    assert(oNParent != NULL);
    assert(oPPath != NULL);
    assert(pulChildID != NULL);
    /* ask preceptor about how to best handle*/
    assert(!Node_isFile(oNParent));
 
-   return DynArray_bsearch(oNParent->oDChildren,
-            (char*) Path_getPathname(oPPath), pulChildID,
-            (int (*)(const void*,const void*)) Node_compareString);
+   ulDepth = Path_getDepth(oPPath);
+   pcComponent = Path_getComponent(oPPath, ulDepth - 1);
+
+   /* only a path one level below oNParent can name its child */
+   if(ulDepth == oNParent->ulDepth + 1 &&
+      Node_isPrefixOf(oNParent, oPPath))
+      return Node_hasChildComponent(oNParent, pcComponent,
+                                    strlen(pcComponent), pulChildID);
+
+   /* any other still gets the place of a file of its last name */
+   (void) Node_searchChildren(oNParent->oCFiles, pcComponent,
+                              strlen(pcComponent), pulChildID);
+   return FALSE;
+}
+
+boolean Node_hasChildComponent(Node_T oNParent, const char *pcComponent,
+                               size_t ulLength, size_t *pulChildID) {
+   size_t ulDirIndex;
+
+   assert(oNParent != NULL);
+   assert(pcComponent != NULL);
+   assert(pulChildID != NULL);
+   assert(!Node_isFile(oNParent));
+
+   if(Node_searchChildren(oNParent->oCFiles, pcComponent, ulLength,
+                          pulChildID))
+      return TRUE;
+   if(!Node_searchChildren(oNParent->oCDirs, pcComponent, ulLength,
+                           &ulDirIndex))
+      return FALSE;
+   /* subdirectories are numbered after the files */
+   *pulChildID = ChunkArray_getLength(oNParent->oCFiles) + ulDirIndex;
+   return TRUE;
+}
+
+boolean Node_findChild(Node_T oNParent, const char *pcComponent,
+                       size_t ulLength, Node_T *poNResult) {
+   unsigned long long ullHash;
+   size_t ulSlot;
+   size_t ulChildID;
+
+   assert(oNParent != NULL);
+   assert(pcComponent != NULL);
+   assert(poNResult != NULL);
+   assert(!Node_isFile(oNParent));
+
+   *poNResult = NULL;
+   if(oNParent->oAIndex != NULL) {
+      *poNResult = Art_get(oNParent->oAIndex, pcComponent, ulLength);
+      return *poNResult != NULL;
+   }
+   if(oNParent->psSlots == NULL) {
+      if(!Node_hasChildComponent(oNParent, pcComponent, ulLength,
+                                 &ulChildID))
+         return FALSE;
+      *poNResult = Node_childAt(oNParent, ulChildID);
+      return TRUE;
+   }
+
+   ullHash = Intern_hash(pcComponent, ulLength);
+   for(ulSlot = (size_t) ullHash & oNParent->ulSlotMask;
+       oNParent->psSlots[ulSlot].oNChild != NULL;
+       ulSlot = (ulSlot + 1) & oNParent->ulSlotMask) {
+      Node_T oNChild = oNParent->psSlots[ulSlot].oNChild;
+
+      if(oNParent->psSlots[ulSlot].ullHash == ullHash &&
+         Intern_getLength(oNChild->pcName) == ulLength &&
+         memcmp(oNChild->pcName, pcComponent, ulLength) == 0) {
+         *poNResult = oNChild;
+         return TRUE;
+      }
+   }
+   return FALSE;
 }
 
 size_t Node_getNumChildren(Node_T oNParent) {
@@ -232,7 +932,17 @@ size_t Node_getNumChildren(Node_T oNParent) {
    if(Node_isFile(oNParent))
       return 0;
 
-   return DynArray_getLength(oNParent->oDChildren);
+   return ChunkArray_getLength(oNParent->oCFiles) +
+      ChunkArray_getLength(oNParent->oCDirs);
+}
+
+size_t Node_getNumFiles(Node_T oNParent) {
+   assert(oNParent != NULL);
+
+   if(Node_isFile(oNParent))
+      return 0;
+
+   return ChunkArray_getLength(oNParent->oCFiles);
 }
 
 int Node_getChild(Node_T oNParent, size_t ulChildID, Node_T *poNResult) {
@@ -245,7 +955,7 @@ int Node_getChild(Node_T oNParent, size_t ulChildID, Node_T *poNResult) {
       return NO_SUCH_PATH;
    }
 
-   *poNResult = DynArray_get(oNParent->oDChildren, ulChildID);
+   *poNResult = Node_childAt(oNParent, ulChildID);
    return SUCCESS;
 }
 
@@ -256,22 +966,68 @@ Node_T Node_getParent(Node_T oNNode) {
 }
 
 int Node_compare(Node_T oNFirst, Node_T oNSecond) {
+   Node_T oNFirstUp = oNFirst, oNSecondUp = oNSecond;
+   Node_T oNFirstBelow = NULL, oNSecondBelow = NULL;
+   const char *pcFirst, *pcSecond;
+   unsigned char ucFirst, ucSecond;
+
    assert(oNFirst != NULL);
    assert(oNSecond != NULL);
 
-   return Path_comparePath(oNFirst->oPPath, oNSecond->oPPath);
+   /* the paths agree down to the nearest common ancestor and first
+      differ in the components just below it, which are found by
+      climbing to it from both nodes, once */
+   while(oNFirstUp->ulDepth > oNSecondUp->ulDepth) {
+      oNFirstBelow = oNFirstUp;
+      oNFirstUp = oNFirstUp->oNParent;
+   }
+   while(oNSecondUp->ulDepth > oNFirstUp->ulDepth) {
+      oNSecondBelow = oNSecondUp;
+      oNSecondUp = oNSecondUp->oNParent;
+   }
+   while(oNFirstUp != oNSecondUp) {
+      oNFirstBelow = oNFirstUp;
+      oNFirstUp = oNFirstUp->oNParent;
+      oNSecondBelow = oNSecondUp;
+      oNSecondUp = oNSecondUp->oNParent;
+      assert(oNFirstUp != NULL);
+   }
+
+   /* a path is less than the paths it is a prefix of */
+   if(oNFirstBelow == NULL)
+      return oNSecondBelow == NULL ? 0 : -1;
+   if(oNSecondBelow == NULL)
+      return 1;
+
+   /* compare the two components as strcmp would compare the rest of
+      the pathnames: the end of one reads as '/', or as '\0' for the
+      last. Siblings' names differ, so the two differ by then. */
+   pcFirst = oNFirstBelow->pcName;
+   pcSecond = oNSecondBelow->pcName;
+   while(*pcFirst != '\0' && *pcFirst == *pcSecond) {
+      pcFirst++;
+      pcSecond++;
+   }
+   ucFirst = (unsigned char) *pcFirst;
+   if(ucFirst == '\0' && oNFirstBelow != oNFirst)
+      ucFirst = '/';
+   ucSecond = (unsigned char) *pcSecond;
+   if(ucSecond == '\0' && oNSecondBelow != oNSecond)
+      ucSecond = '/';
+   return (int) ucFirst - (int) ucSecond;
 }
 
 char *Node_toString(Node_T oNNode) {
    char *pcCopy;
 
    assert(oNNode != NULL);
-   /* copy so that the caller can own this string rep. */
-   pcCopy = malloc(Path_getStrLength(Node_getPath(oNNode)) + 1);
+   /* rebuilt here, so the caller owns this string rep. */
+   pcCopy = malloc(Node_getPathLength(oNNode) + 1);
    if(pcCopy == NULL)
       return NULL;
 
-   return strcpy(pcCopy, Path_getPathname(Node_getPath(oNNode)));
+   (void) Node_writePath(oNNode, pcCopy);
+   return pcCopy;
 }
 
 void *Node_getContents(Node_T oNNode) {
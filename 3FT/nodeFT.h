@@ -9,10 +9,45 @@
 #include <stddef.h>
 #include "a4def.h"
 #include "path.h"
+#include "region.h"
+#include "slab.h"
 
 /* A Node_T is a node in a File Tree */
 typedef struct node *Node_T;
 
+/* The auxiliary index a directory keeps over its children's names,
+   beside the sorted arrays of its files and subdirectories that give
+   them their identifiers: NODE_INDEX_SORTED keeps none and binary
+   searches the arrays,
+   NODE_INDEX_HASH keeps a hash table once fanout is high, and
+   NODE_INDEX_ART keeps an adaptive radix tree at every fanout. */
+enum Node_ChildIndex { NODE_INDEX_SORTED, NODE_INDEX_HASH,
+                       NODE_INDEX_ART };
+
+/*
+  Makes directories keep an index of kind eIndex. Must only be called
+  while no nodes exist; the default is NODE_INDEX_HASH.
+*/
+void Node_setChildIndex(enum Node_ChildIndex eIndex);
+
+/*
+  Makes new nodes, and everything they allocate, come from oRRegion,
+  or from the slab and malloc if it is NULL. Must only be called while
+  no nodes exist, or when the nodes of the region in use are about to
+  be discarded with it, without Node_free: they hold no references to
+  their names, which this releases instead.
+*/
+void Node_setRegion(Region_T oRRegion);
+
+/* Fills *psStats with the counters of the slab that nodes are
+   allocated from. */
+void Node_getSlabStats(struct Slab_Stats *psStats);
+
+/* Frees the slabs that nodes and their child arrays are allocated
+   from, with their pages, if no node from them exists. Later nodes
+   make new ones. */
+void Node_freeSlabs(void);
+
 /*
   Creates a new node in the File Tree, with path oPPath, parent oNParent,
   and type determined by bIsFile (T = file F = directory ). If creating a 
@@ -33,11 +68,57 @@ int Node_new(Path_T oPPath, Node_T oNParent, boolean bIsFile,
 
 /* Destroys and frees all memory allocated for the subtree rooted at
   oNNode, i.e., deletes this node and all its descendents. Returns the
-  number of nodes deleted. */
+  number of nodes deleted. Takes time linear in that number and no
+  stack space that grows with the subtree's depth. */
 size_t Node_free(Node_T oNNode);
 
-/* Returns the path object representing oNNode's absolute path. */
-Path_T Node_getPath(Node_T oNNode);
+/* Frees the subtree rooted at oNNode as Node_free does, calling
+  (*pfVisit)(oNCurr, TRUE, pvExtra) when the teardown reaches each of
+  its nodes, a node before any of its descendents, and
+  (*pfVisit)(oNCurr, FALSE, pvExtra) just before freeing it, once all
+  its descendents are gone. pfVisit may read the node but not change
+  the tree. Returns the number of nodes deleted. */
+size_t Node_freeVisiting(Node_T oNNode,
+                         void (*pfVisit)(Node_T oNNode, boolean bArriving,
+                                         void *pvExtra),
+                         void *pvExtra);
+
+/*
+  Creates a new path object representing oNNode's absolute path, which
+  nodes do not store and so is rebuilt from oNNode's ancestors.
+  Returns an int SUCCESS status and sets *poPResult to be the new path,
+  which is then owned by the caller, if successful. Otherwise, sets
+  *poPResult to NULL and returns status:
+  * MEMORY_ERROR if memory could not be allocated to complete request
+*/
+int Node_getPath(Node_T oNNode, Path_T *poPResult);
+
+/* Returns oNNode's own (final) path component. */
+const char *Node_getName(Node_T oNNode);
+
+/* Returns the number of components in oNNode's absolute path. */
+size_t Node_getDepth(Node_T oNNode);
+
+/*
+  Returns the length (not including trailing '\0') of the string
+  representation of oNNode's absolute path.
+*/
+size_t Node_getPathLength(Node_T oNNode);
+
+/*
+  Writes oNNode's absolute path, followed by '\0', into pcBuf, which
+  must have room for at least Node_getPathLength(oNNode) + 1 bytes.
+  Returns the length of the path written.
+*/
+size_t Node_writePath(Node_T oNNode, char *pcBuf);
+
+/*
+  Returns TRUE if oNNode's absolute path is exactly the ulLength bytes
+  at pcPath, which need not be '\0'-terminated, and FALSE otherwise.
+  Compares one name per ancestor without rebuilding the path.
+*/
+boolean Node_matchesPath(Node_T oNNode, const char *pcPath,
+                         size_t ulLength);
 
 /* Returns TRUE if oNNode represents a file. Otherwise, returns FALSE 
 meaning oNNode represents a directory */
@@ -48,18 +129,47 @@ boolean Node_isFile(Node_T oNNode);
   FALSE if it does not.
   If oNParent has such a child, stores in *pulChildID the child's
   identifier (as used in Node_getChild). If oNParent does not have
-  such a child, stores in *pulChildID the identifier that such a
-  child would have if inserted.
+  such a child, stores in *pulChildID the identifier that a file
+  named for oPPath's last component would have if inserted.
 */
 boolean Node_hasChild(Node_T oNParent, Path_T oPPath, size_t *pulChildID);
 
+/*
+  Returns TRUE if oNParent has a child whose final path component is
+  the ulLength bytes at pcComponent (which need not be '\0'-terminated),
+  and FALSE if it does not. Sets *pulChildID exactly as Node_hasChild
+  does. Since siblings share their parent's path, this is equivalent
+  to Node_hasChild on the full path, but it needs no Path_T and so
+  lets callers walk a path without allocating prefixes.
+*/
+boolean Node_hasChildComponent(Node_T oNParent, const char *pcComponent,
+                               size_t ulLength, size_t *pulChildID);
+
+/*
+  Returns TRUE if oNParent has a child whose final path component is
+  the ulLength bytes at pcComponent (which need not be '\0'-terminated)
+  and sets *poNResult to that child. Otherwise, sets *poNResult to NULL
+  and returns FALSE. Unlike Node_hasChildComponent this does not
+  report the child's identifier, so it can look the name up in the
+  directory's index (see Node_setChildIndex) rather than searching.
+*/
+boolean Node_findChild(Node_T oNParent, const char *pcComponent,
+                       size_t ulLength, Node_T *poNResult);
+
 /* Returns the number of children that oNParent has. */
 size_t Node_getNumChildren(Node_T oNParent);
 
+/* Returns the number of oNParent's children that are files, which are
+   those whose identifiers are below it (see Node_getChild). */
+size_t Node_getNumFiles(Node_T oNParent);
+
 /* Returns an int SUCCESS status and sets *poNResult to be the child
   node of oNParent with identifier ulChildID, if one exists.
   Otherwise, sets *poNResult to NULL and returns status:
-  * NO_SUCH_PATH if ulChildID is not a valid child for oNParent */
+  * NO_SUCH_PATH if ulChildID is not a valid child for oNParent
+  The identifiers number oNParent's files in order of name, then its
+  subdirectories in order of name, which is the order FT_toString
+  lists them in. */
 int Node_getChild(Node_T oNParent, size_t ulChildID, Node_T *poNResult);
 
 /*
@@ -69,7 +179,9 @@ int Node_getChild(Node_T oNParent, size_t ulChildID, Node_T *poNResult);
 Node_T Node_getParent(Node_T oNNode);
 
 /*
-  Compares oNFirst and oNSecond lexicographically based on their paths.
+  Compares oNFirst and oNSecond, which must be in the same tree,
+  lexicographically based on their paths, in time linear in their
+  depths.
   Returns <0, 0, or >0 if onFirst is "less than", "equal to", or
   "greater than" oNSecond, respectively.
 */
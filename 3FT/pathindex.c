@@ -0,0 +1,179 @@
+/*--------------------------------------------------------------------*/
+/* pathindex.c                                                        */
+/* Author: Zara Hommez                                                */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "pathindex.h"
+
+/* The number of slots the table starts with */
+enum { INITIAL_SLOT_COUNT = 64 };
+
+/* One slot of the table */
+struct slot {
+   /* the hash of the node's path */
+   unsigned long long ullHash;
+   /* the node, or NULL if this slot is empty */
+   Node_T oNNode;
+};
+
+/* An open-addressing (linear probing) table, kept at most three
+   quarters full */
+struct pathIndex {
+   /* the slots; their number is a power of 2 */
+   struct slot *psSlots;
+   /* the number of slots less one */
+   size_t ulMask;
+   /* the counters reported by PathIndex_getStats */
+   struct PathIndex_Stats sStats;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Stores oNNode, whose path hashes to ullHash, in the first empty
+   slot of its probe sequence in psSlots. */
+static void PathIndex_put(struct slot *psSlots, size_t ulMask,
+                          unsigned long long ullHash, Node_T oNNode) {
+   size_t ulSlot;
+
+   assert(psSlots != NULL);
+   assert(oNNode != NULL);
+
+   for(ulSlot = (size_t) ullHash & ulMask; psSlots[ulSlot].oNNode != NULL;
+       ulSlot = (ulSlot + 1) & ulMask)
+      ;
+   psSlots[ulSlot].ullHash = ullHash;
+   psSlots[ulSlot].oNNode = oNNode;
+}
+
+/* Moves every entry of oPIIndex into a table of twice as many slots.
+   Returns SUCCESS, or MEMORY_ERROR, leaving oPIIndex as it was, if
+   memory could not be allocated. */
+static int PathIndex_grow(PathIndex_T oPIIndex) {
+   struct slot *psNew;
+   size_t ulSlots = 2 * oPIIndex->sStats.ulSlots;
+   size_t i;
+
+   assert(oPIIndex != NULL);
+
+   psNew = calloc(ulSlots, sizeof(struct slot));
+   if(psNew == NULL)
+      return MEMORY_ERROR;
+   for(i = 0; i < oPIIndex->sStats.ulSlots; i++)
+      if(oPIIndex->psSlots[i].oNNode != NULL)
+         PathIndex_put(psNew, ulSlots - 1, oPIIndex->psSlots[i].ullHash,
+                       oPIIndex->psSlots[i].oNNode);
+
+   free(oPIIndex->psSlots);
+   oPIIndex->psSlots = psNew;
+   oPIIndex->ulMask = ulSlots - 1;
+   oPIIndex->sStats.ulBytes += (ulSlots - oPIIndex->sStats.ulSlots) *
+      sizeof(struct slot);
+   oPIIndex->sStats.ulSlots = ulSlots;
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+
+PathIndex_T PathIndex_new(void) {
+   PathIndex_T oPIIndex;
+
+   oPIIndex = calloc(1, sizeof(struct pathIndex));
+   if(oPIIndex == NULL)
+      return NULL;
+   oPIIndex->psSlots = calloc(INITIAL_SLOT_COUNT, sizeof(struct slot));
+   if(oPIIndex->psSlots == NULL) {
+      free(oPIIndex);
+      return NULL;
+   }
+   oPIIndex->ulMask = INITIAL_SLOT_COUNT - 1;
+   oPIIndex->sStats.ulSlots = INITIAL_SLOT_COUNT;
+   oPIIndex->sStats.ulBytes = sizeof(struct pathIndex) +
+      INITIAL_SLOT_COUNT * sizeof(struct slot);
+   return oPIIndex;
+}
+
+void PathIndex_free(PathIndex_T oPIIndex) {
+   if(oPIIndex == NULL)
+      return;
+
+   free(oPIIndex->psSlots);
+   free(oPIIndex);
+}
+
+int PathIndex_add(PathIndex_T oPIIndex, unsigned long long ullHash,
+                  Node_T oNNode) {
+   assert(oPIIndex != NULL);
+   assert(oNNode != NULL);
+
+   if(4 * (oPIIndex->sStats.ulEntries + 1) > 3 * oPIIndex->sStats.ulSlots &&
+      PathIndex_grow(oPIIndex) != SUCCESS)
+      return MEMORY_ERROR;
+
+   PathIndex_put(oPIIndex->psSlots, oPIIndex->ulMask, ullHash, oNNode);
+   oPIIndex->sStats.ulEntries++;
+   return SUCCESS;
+}
+
+void PathIndex_remove(PathIndex_T oPIIndex, unsigned long long ullHash,
+                      Node_T oNNode) {
+   struct slot *psSlots;
+   size_t ulMask;
+   size_t ulHole, ulSlot;
+
+   assert(oPIIndex != NULL);
+   assert(oNNode != NULL);
+
+   psSlots = oPIIndex->psSlots;
+   ulMask = oPIIndex->ulMask;
+   for(ulHole = (size_t) ullHash & ulMask; psSlots[ulHole].oNNode != oNNode;
+       ulHole = (ulHole + 1) & ulMask)
+      if(psSlots[ulHole].oNNode == NULL)
+         return;
+
+   /* close the hole by moving back any later entry of the same run
+      that may no longer be reachable from its home slot */
+   for(ulSlot = (ulHole + 1) & ulMask; psSlots[ulSlot].oNNode != NULL;
+       ulSlot = (ulSlot + 1) & ulMask) {
+      size_t ulHome = (size_t) psSlots[ulSlot].ullHash & ulMask;
+      if(((ulSlot - ulHome) & ulMask) >= ((ulSlot - ulHole) & ulMask)) {
+         psSlots[ulHole] = psSlots[ulSlot];
+         ulHole = ulSlot;
+      }
+   }
+   psSlots[ulHole].oNNode = NULL;
+   oPIIndex->sStats.ulEntries--;
+}
+
+Node_T PathIndex_find(PathIndex_T oPIIndex, unsigned long long ullHash,
+                      const char *pcPath, size_t ulLength) {
+   size_t ulSlot;
+
+   assert(oPIIndex != NULL);
+   assert(pcPath != NULL);
+
+   oPIIndex->sStats.ulLookups++;
+   for(ulSlot = (size_t) ullHash & oPIIndex->ulMask;
+       oPIIndex->psSlots[ulSlot].oNNode != NULL;
+       ulSlot = (ulSlot + 1) & oPIIndex->ulMask) {
+      oPIIndex->sStats.ulProbes++;
+      if(oPIIndex->psSlots[ulSlot].ullHash == ullHash &&
+         Node_matchesPath(oPIIndex->psSlots[ulSlot].oNNode, pcPath,
+                          ulLength)) {
+         oPIIndex->sStats.ulHits++;
+         return oPIIndex->psSlots[ulSlot].oNNode;
+      }
+   }
+   oPIIndex->sStats.ulProbes++;
+   return NULL;
+}
+
+void PathIndex_getStats(PathIndex_T oPIIndex,
+                        struct PathIndex_Stats *psStats) {
+   assert(oPIIndex != NULL);
+   assert(psStats != NULL);
+
+   *psStats = oPIIndex->sStats;
+}
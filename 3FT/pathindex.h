@@ -0,0 +1,70 @@
+/*--------------------------------------------------------------------*/
+/* pathindex.h                                                        */
+/* Author: Zara Hommez                                                */
+/*--------------------------------------------------------------------*/
+
+#ifndef PATHINDEX_INCLUDED
+#define PATHINDEX_INCLUDED
+
+/*
+  A PathIndex_T maps the absolute paths of the nodes of a File Tree
+  to the nodes, so that a node can be found from its path with one
+  hash and one comparison however deep it is. Entries are keyed by
+  the hash Path_getPrefixHash gives the node's path; the paths
+  themselves are not stored, but checked against the nodes.
+*/
+
+#include <stddef.h>
+#include "a4def.h"
+#include "nodeFT.h"
+
+typedef struct pathIndex *PathIndex_T;
+
+/* Counters describing the size and use of a PathIndex_T */
+struct PathIndex_Stats {
+   /* the number of nodes indexed */
+   size_t ulEntries;
+   /* the number of slots in the table */
+   size_t ulSlots;
+   /* the bytes allocated for the index, including its handle */
+   size_t ulBytes;
+   /* the number of PathIndex_find calls */
+   size_t ulLookups;
+   /* the number of those calls that found a node */
+   size_t ulHits;
+   /* the number of slots those calls examined */
+   size_t ulProbes;
+};
+
+/* Returns a new, empty PathIndex_T, or NULL if memory could not be
+   allocated. */
+PathIndex_T PathIndex_new(void);
+
+/* Frees oPIIndex, but not the nodes in it. */
+void PathIndex_free(PathIndex_T oPIIndex);
+
+/*
+  Adds oNNode, whose path hashes to ullHash, to oPIIndex. Returns
+  SUCCESS, or MEMORY_ERROR, leaving oPIIndex as it was, if memory
+  could not be allocated.
+*/
+int PathIndex_add(PathIndex_T oPIIndex, unsigned long long ullHash,
+                  Node_T oNNode);
+
+/* Removes oNNode, whose path hashes to ullHash, from oPIIndex, if it
+   is there. */
+void PathIndex_remove(PathIndex_T oPIIndex, unsigned long long ullHash,
+                      Node_T oNNode);
+
+/*
+  Returns the node in oPIIndex whose path is the ulLength bytes at
+  pcPath, which hash to ullHash, or NULL if there is none.
+*/
+Node_T PathIndex_find(PathIndex_T oPIIndex, unsigned long long ullHash,
+                      const char *pcPath, size_t ulLength);
+
+/* Fills *psStats with oPIIndex's counters. */
+void PathIndex_getStats(PathIndex_T oPIIndex,
+                        struct PathIndex_Stats *psStats);
+
+#endif
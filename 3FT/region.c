@@ -0,0 +1,272 @@
+/*--------------------------------------------------------------------*/
+/* region.c                                                           */
+/* Author: Zara Hommez                                                */
+/*--------------------------------------------------------------------*/
+
+/* for posix_memalign and madvise */
+#define _DEFAULT_SOURCE
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "region.h"
+
+/* Sizes of the blocks allocations are carved from, ordinary and huge
+   page backed; the latter are also aligned to their size */
+enum { BLOCK_SIZE = 1024 * 1024, HUGE_BLOCK_SIZE = 2 * 1024 * 1024 };
+
+/* Every allocation is rounded up to a multiple of GRANULE bytes, which
+   keeps it aligned for any type the tree stores */
+enum { GRANULE = 16 };
+
+/* Size classes: one per GRANULE up to SMALL_LIMIT, then one per power
+   of 2 up to LARGE_LIMIT; anything larger gets a block of its own */
+enum { SMALL_LIMIT = 256, LARGE_LIMIT = 64 * 1024 };
+enum { SMALL_CLASSES = SMALL_LIMIT / GRANULE, CLASSES = SMALL_CLASSES + 8 };
+
+/* A released allocation, linked through its first bytes */
+struct freeObject {
+   struct freeObject *psNext;
+};
+
+/* The header of a block, padded to GRANULE bytes. A block for a single
+   large allocation is also on a doubly linked list, so that it can be
+   freed on its own. */
+struct block {
+   struct block *psNext;
+   struct block *psPrev;
+};
+
+enum { BLOCK_HEADER = (sizeof(struct block) + GRANULE - 1) / GRANULE *
+       GRANULE };
+
+struct region {
+   /* the blocks allocations are carved from, newest first */
+   struct block *psBlocks;
+   /* the blocks each holding one large allocation */
+   struct block *psLarge;
+   /* the next free byte of the newest block, and its end */
+   char *pcNext;
+   char *pcLimit;
+   /* the size of each block */
+   size_t ulBlockSize;
+   /* whether blocks are meant for huge pages */
+   boolean bHugePages;
+   /* one free list per size class */
+   struct freeObject *apsFree[CLASSES];
+   /* the counters Region_getStats reports */
+   struct Region_Stats sStats;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Returns the size class of an allocation of ulSize bytes, at most
+   LARGE_LIMIT, and sets *pulRounded to the size that class gives it. */
+static size_t Region_classOf(size_t ulSize, size_t *pulRounded) {
+   size_t ulClass, ulRounded;
+
+   assert(pulRounded != NULL);
+   assert(ulSize <= LARGE_LIMIT);
+
+   if(ulSize == 0)
+      ulSize = 1;
+   if(ulSize <= SMALL_LIMIT) {
+      ulClass = (ulSize - 1) / GRANULE;
+      *pulRounded = (ulClass + 1) * GRANULE;
+      return ulClass;
+   }
+   ulClass = SMALL_CLASSES;
+   for(ulRounded = 2 * SMALL_LIMIT; ulRounded < ulSize; ulRounded *= 2)
+      ulClass++;
+   *pulRounded = ulRounded;
+   return ulClass;
+}
+
+/* Returns a new block of oRRegion's block size, linked into its block
+   list, or NULL if memory could not be allocated. */
+static struct block *Region_newBlock(Region_T oRRegion) {
+   void *pvBlock;
+
+   assert(oRRegion != NULL);
+
+   if(oRRegion->bHugePages) {
+      if(posix_memalign(&pvBlock, HUGE_BLOCK_SIZE, HUGE_BLOCK_SIZE) != 0)
+         return NULL;
+#ifdef MADV_HUGEPAGE
+      /* only advice: the block is usable whatever the answer */
+      (void) madvise(pvBlock, HUGE_BLOCK_SIZE, MADV_HUGEPAGE);
+#endif
+   }
+   else {
+      pvBlock = malloc(BLOCK_SIZE);
+      if(pvBlock == NULL)
+         return NULL;
+   }
+   ((struct block *) pvBlock)->psNext = oRRegion->psBlocks;
+   oRRegion->psBlocks = pvBlock;
+   oRRegion->sStats.ulBlocks++;
+   oRRegion->sStats.ulBytes += oRRegion->ulBlockSize;
+   return pvBlock;
+}
+
+/* Returns a new allocation of ulSize bytes, more than LARGE_LIMIT, in
+   a block of its own, or NULL if memory could not be allocated. */
+static void *Region_allocLarge(Region_T oRRegion, size_t ulSize) {
+   struct block *psBlock;
+
+   assert(oRRegion != NULL);
+   assert(ulSize > LARGE_LIMIT);
+
+   psBlock = malloc(BLOCK_HEADER + ulSize);
+   if(psBlock == NULL)
+      return NULL;
+   psBlock->psPrev = NULL;
+   psBlock->psNext = oRRegion->psLarge;
+   if(oRRegion->psLarge != NULL)
+      oRRegion->psLarge->psPrev = psBlock;
+   oRRegion->psLarge = psBlock;
+   oRRegion->sStats.ulBlocks++;
+   oRRegion->sStats.ulBytes += BLOCK_HEADER + ulSize;
+   oRRegion->sStats.ulInUse += ulSize;
+   return (char *) psBlock + BLOCK_HEADER;
+}
+
+/* Frees pvObject, of ulSize bytes, which Region_allocLarge gave out
+   for oRRegion. */
+static void Region_releaseLarge(Region_T oRRegion, void *pvObject,
+                                size_t ulSize) {
+   struct block *psBlock;
+
+   assert(oRRegion != NULL);
+   assert(pvObject != NULL);
+
+   psBlock = (struct block *) (void *) ((char *) pvObject - BLOCK_HEADER);
+   if(psBlock->psPrev != NULL)
+      psBlock->psPrev->psNext = psBlock->psNext;
+   else
+      oRRegion->psLarge = psBlock->psNext;
+   if(psBlock->psNext != NULL)
+      psBlock->psNext->psPrev = psBlock->psPrev;
+   free(psBlock);
+   oRRegion->sStats.ulBlocks--;
+   oRRegion->sStats.ulBytes -= BLOCK_HEADER + ulSize;
+   oRRegion->sStats.ulInUse -= ulSize;
+}
+
+/*--------------------------------------------------------------------*/
+
+Region_T Region_new(boolean bHugePages) {
+   Region_T oRRegion;
+
+   oRRegion = calloc(1, sizeof(struct region));
+   if(oRRegion == NULL)
+      return NULL;
+   oRRegion->bHugePages = bHugePages;
+   oRRegion->ulBlockSize = bHugePages ? HUGE_BLOCK_SIZE : BLOCK_SIZE;
+   return oRRegion;
+}
+
+void Region_free(Region_T oRRegion) {
+   struct block *psBlock;
+
+   if(oRRegion == NULL)
+      return;
+
+   while((psBlock = oRRegion->psBlocks) != NULL) {
+      oRRegion->psBlocks = psBlock->psNext;
+      free(psBlock);
+   }
+   while((psBlock = oRRegion->psLarge) != NULL) {
+      oRRegion->psLarge = psBlock->psNext;
+      free(psBlock);
+   }
+   free(oRRegion);
+}
+
+void *Region_alloc(Region_T oRRegion, size_t ulSize) {
+   size_t ulClass, ulRounded;
+   struct freeObject *psObject;
+
+   if(oRRegion == NULL)
+      return malloc(ulSize);
+
+   if(ulSize > LARGE_LIMIT)
+      return Region_allocLarge(oRRegion, ulSize);
+
+   ulClass = Region_classOf(ulSize, &ulRounded);
+   psObject = oRRegion->apsFree[ulClass];
+   if(psObject != NULL) {
+      oRRegion->apsFree[ulClass] = psObject->psNext;
+      oRRegion->sStats.ulRecycled++;
+   }
+   else {
+      /* the rest of a block too small for this is simply left over */
+      if(oRRegion->pcNext == NULL ||
+         (size_t) (oRRegion->pcLimit - oRRegion->pcNext) < ulRounded) {
+         struct block *psBlock = Region_newBlock(oRRegion);
+         if(psBlock == NULL)
+            return NULL;
+         oRRegion->pcNext = (char *) psBlock + BLOCK_HEADER;
+         oRRegion->pcLimit = (char *) psBlock + oRRegion->ulBlockSize;
+      }
+      psObject = (struct freeObject *) (void *) oRRegion->pcNext;
+      oRRegion->pcNext += ulRounded;
+   }
+   oRRegion->sStats.ulInUse += ulRounded;
+   return psObject;
+}
+
+void *Region_resize(Region_T oRRegion, void *pvOld, size_t ulOldSize,
+                    size_t ulNewSize) {
+   void *pvNew;
+   size_t ulOldRounded, ulNewRounded;
+
+   if(oRRegion == NULL)
+      return realloc(pvOld, ulNewSize);
+
+   if(pvOld == NULL)
+      return Region_alloc(oRRegion, ulNewSize);
+
+   /* an allocation already big enough for its new size class stays */
+   if(ulOldSize <= LARGE_LIMIT && ulNewSize <= LARGE_LIMIT &&
+      Region_classOf(ulOldSize, &ulOldRounded) ==
+         Region_classOf(ulNewSize, &ulNewRounded))
+      return pvOld;
+
+   pvNew = Region_alloc(oRRegion, ulNewSize);
+   if(pvNew == NULL)
+      return NULL;
+   memcpy(pvNew, pvOld, ulOldSize < ulNewSize ? ulOldSize : ulNewSize);
+   Region_release(oRRegion, pvOld, ulOldSize);
+   return pvNew;
+}
+
+void Region_release(Region_T oRRegion, void *pvObject, size_t ulSize) {
+   size_t ulClass, ulRounded;
+   struct freeObject *psObject = pvObject;
+
+   if(oRRegion == NULL) {
+      free(pvObject);
+      return;
+   }
+   if(pvObject == NULL)
+      return;
+
+   if(ulSize > LARGE_LIMIT) {
+      Region_releaseLarge(oRRegion, pvObject, ulSize);
+      return;
+   }
+   ulClass = Region_classOf(ulSize, &ulRounded);
+   psObject->psNext = oRRegion->apsFree[ulClass];
+   oRRegion->apsFree[ulClass] = psObject;
+   oRRegion->sStats.ulInUse -= ulRounded;
+}
+
+void Region_getStats(Region_T oRRegion, struct Region_Stats *psStats) {
+   assert(oRRegion != NULL);
+   assert(psStats != NULL);
+
+   *psStats = oRRegion->sStats;
+}
@@ -0,0 +1,73 @@
+/*--------------------------------------------------------------------*/
+/* region.h                                                           */
+/* Author: Zara Hommez                                                */
+/*--------------------------------------------------------------------*/
+
+#ifndef REGION_INCLUDED
+#define REGION_INCLUDED
+
+/*
+  A Region_T carves allocations of any size out of a few large blocks,
+  so that everything allocated from it is freed at once, whatever its
+  number, by Region_free. Memory released before then is kept in free
+  lists by size class and reused by later allocations of that class;
+  allocations too large for any class get blocks of their own.
+  Every function here also accepts a NULL Region_T, in which case it
+  behaves as the corresponding C library function does, so a module
+  can take an optional region without two code paths.
+*/
+
+#include <stddef.h>
+#include "a4def.h"
+
+typedef struct region *Region_T;
+
+/* Counters describing a Region_T's memory use */
+struct Region_Stats {
+   /* the number of blocks allocated, including those for single large
+      allocations */
+   size_t ulBlocks;
+   /* the bytes those blocks take up */
+   size_t ulBytes;
+   /* the bytes allocated and not yet released, rounded up to their
+      size classes */
+   size_t ulInUse;
+   /* the number of allocations served from a free list */
+   size_t ulRecycled;
+};
+
+/*
+  Returns a new, empty Region_T, or NULL if memory could not be
+  allocated. If bHugePages is TRUE, its blocks are sized and aligned
+  for huge pages, and the system is asked to back them with huge pages
+  where it can.
+*/
+Region_T Region_new(boolean bHugePages);
+
+/* Frees oRRegion and everything allocated from it, in time that
+   depends only on the number of its blocks. */
+void Region_free(Region_T oRRegion);
+
+/* Returns ulSize new bytes from oRRegion, or from malloc if oRRegion
+   is NULL, or NULL if memory could not be allocated. */
+void *Region_alloc(Region_T oRRegion, size_t ulSize);
+
+/*
+  Returns a block of ulNewSize bytes holding the first bytes of pvOld,
+  as many as fit, and releases pvOld, which was allocated from
+  oRRegion with ulOldSize bytes, as realloc does. pvOld may be NULL.
+  Returns NULL, leaving pvOld as it was, if memory could not be
+  allocated.
+*/
+void *Region_resize(Region_T oRRegion, void *pvOld, size_t ulOldSize,
+                    size_t ulNewSize);
+
+/* Releases pvObject, which was allocated from oRRegion with ulSize
+   bytes, for reuse, or frees it if oRRegion is NULL. pvObject may be
+   NULL. */
+void Region_release(Region_T oRRegion, void *pvObject, size_t ulSize);
+
+/* Fills *psStats with oRRegion's counters. */
+void Region_getStats(Region_T oRRegion, struct Region_Stats *psStats);
+
+#endif
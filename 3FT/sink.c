@@ -0,0 +1,280 @@
+/*--------------------------------------------------------------------*/
+/* sink.c                                                             */
+/* Author: Zara Hommez                                                */
+/*--------------------------------------------------------------------*/
+
+/* for writev */
+#define _DEFAULT_SOURCE
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "sink.h"
+
+/* The bytes a file descriptor sink gathers before writing them */
+enum { GATHER_SIZE = 64 * 1024 };
+
+/* The physical length of a buffer sink's first buffer */
+enum { MIN_BUFFER_SIZE = 256 };
+
+/* The kinds of Sink_T */
+enum sinkKind { SINK_BUFFER, SINK_FILE, SINK_FD, SINK_CALLBACK };
+
+struct sink {
+   /* what kind of sink this is, which says which fields below apply */
+   enum sinkKind eKind;
+   /* FALSE once a write has failed */
+   boolean bOk;
+   /* the number of bytes written to the sink */
+   size_t ulLength;
+   /* SINK_BUFFER: the bytes written, and the room for them;
+      SINK_FD: the bytes gathered, and the room for them */
+   char *pcBuffer;
+   size_t ulUsed;
+   size_t ulPhys;
+   /* SINK_FILE: the stream */
+   FILE *psFile;
+   /* SINK_FD: the file descriptor */
+   int iFd;
+   /* SINK_CALLBACK: the function and its extra argument */
+   boolean (*pfWrite)(const char *pcData, size_t ulLength,
+                      void *pvExtra);
+   void *pvExtra;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Returns a new Sink_T of kind eKind with nothing else set, or NULL if
+   memory could not be allocated. */
+static Sink_T Sink_new(enum sinkKind eKind) {
+   Sink_T oSSink;
+
+   oSSink = calloc(1, sizeof(struct sink));
+   if(oSSink == NULL)
+      return NULL;
+   oSSink->eKind = eKind;
+   oSSink->bOk = TRUE;
+   oSSink->iFd = -1;
+   return oSSink;
+}
+
+/* Writes all iCount buffers of psVectors to oSSink's file descriptor,
+   however many calls that takes. Returns TRUE, or FALSE if a write
+   fails. Changes psVectors. */
+static boolean Sink_writeAll(Sink_T oSSink, struct iovec *psVectors,
+                             int iCount) {
+   assert(oSSink != NULL);
+   assert(psVectors != NULL);
+
+   while(iCount > 0) {
+      ssize_t lWritten = writev(oSSink->iFd, psVectors, iCount);
+      size_t ulWritten;
+
+      if(lWritten < 0) {
+         if(errno == EINTR)
+            continue;
+         return FALSE;
+      }
+      /* skip what went out, which may end partway through a buffer */
+      ulWritten = (size_t) lWritten;
+      while(iCount > 0 && ulWritten >= psVectors->iov_len) {
+         ulWritten -= psVectors->iov_len;
+         psVectors++;
+         iCount--;
+      }
+      if(iCount > 0) {
+         psVectors->iov_base = (char *) psVectors->iov_base + ulWritten;
+         psVectors->iov_len -= ulWritten;
+      }
+   }
+   return TRUE;
+}
+
+/* Writes the ulLength bytes at pcData to oSSink, a file descriptor
+   sink, behind those it has gathered. Returns TRUE, or FALSE if a
+   write fails. */
+static boolean Sink_writeFd(Sink_T oSSink, const char *pcData,
+                            size_t ulLength) {
+   struct iovec asVectors[2];
+
+   assert(oSSink != NULL);
+
+   if(oSSink->ulUsed + ulLength <= oSSink->ulPhys) {
+      memcpy(oSSink->pcBuffer + oSSink->ulUsed, pcData, ulLength);
+      oSSink->ulUsed += ulLength;
+      return TRUE;
+   }
+
+   /* too much to gather: send both in one call rather than copying */
+   asVectors[0].iov_base = oSSink->pcBuffer;
+   asVectors[0].iov_len = oSSink->ulUsed;
+   asVectors[1].iov_base = (void *) pcData;
+   asVectors[1].iov_len = ulLength;
+   oSSink->ulUsed = 0;
+   return Sink_writeAll(oSSink, asVectors, 2);
+}
+
+/* Writes the ulLength bytes at pcData to oSSink, a buffer sink,
+   growing its buffer as needed. Returns TRUE, or FALSE if memory
+   could not be allocated. */
+static boolean Sink_writeBuffer(Sink_T oSSink, const char *pcData,
+                                size_t ulLength) {
+   assert(oSSink != NULL);
+
+   /* one byte more than the bytes written, for Sink_takeString */
+   if(oSSink->ulUsed + ulLength + 1 > oSSink->ulPhys) {
+      size_t ulNewPhys = oSSink->ulPhys == 0 ? MIN_BUFFER_SIZE :
+         oSSink->ulPhys;
+      char *pcNew;
+
+      while(ulNewPhys < oSSink->ulUsed + ulLength + 1)
+         ulNewPhys *= 2;
+      pcNew = realloc(oSSink->pcBuffer, ulNewPhys);
+      if(pcNew == NULL)
+         return FALSE;
+      oSSink->pcBuffer = pcNew;
+      oSSink->ulPhys = ulNewPhys;
+   }
+   memcpy(oSSink->pcBuffer + oSSink->ulUsed, pcData, ulLength);
+   oSSink->ulUsed += ulLength;
+   return TRUE;
+}
+
+/*--------------------------------------------------------------------*/
+
+Sink_T Sink_newBuffer(void) {
+   return Sink_new(SINK_BUFFER);
+}
+
+Sink_T Sink_newFile(FILE *psFile) {
+   Sink_T oSSink;
+
+   assert(psFile != NULL);
+
+   oSSink = Sink_new(SINK_FILE);
+   if(oSSink == NULL)
+      return NULL;
+   oSSink->psFile = psFile;
+   return oSSink;
+}
+
+Sink_T Sink_newFd(int iFd) {
+   Sink_T oSSink;
+
+   assert(iFd >= 0);
+
+   oSSink = Sink_new(SINK_FD);
+   if(oSSink == NULL)
+      return NULL;
+   oSSink->pcBuffer = malloc(GATHER_SIZE);
+   if(oSSink->pcBuffer == NULL) {
+      free(oSSink);
+      return NULL;
+   }
+   oSSink->ulPhys = GATHER_SIZE;
+   oSSink->iFd = iFd;
+   return oSSink;
+}
+
+Sink_T Sink_newCallback(boolean (*pfWrite)(const char *pcData,
+                                           size_t ulLength,
+                                           void *pvExtra),
+                        void *pvExtra) {
+   Sink_T oSSink;
+
+   assert(pfWrite != NULL);
+
+   oSSink = Sink_new(SINK_CALLBACK);
+   if(oSSink == NULL)
+      return NULL;
+   oSSink->pfWrite = pfWrite;
+   oSSink->pvExtra = pvExtra;
+   return oSSink;
+}
+
+boolean Sink_write(Sink_T oSSink, const char *pcData, size_t ulLength) {
+   assert(oSSink != NULL);
+   assert(pcData != NULL || ulLength == 0);
+
+   if(!oSSink->bOk)
+      return FALSE;
+
+   switch(oSSink->eKind) {
+      case SINK_BUFFER:
+         oSSink->bOk = Sink_writeBuffer(oSSink, pcData, ulLength);
+         break;
+      case SINK_FILE:
+         oSSink->bOk = fwrite(pcData, 1, ulLength, oSSink->psFile) ==
+            ulLength;
+         break;
+      case SINK_FD:
+         oSSink->bOk = Sink_writeFd(oSSink, pcData, ulLength);
+         break;
+      case SINK_CALLBACK:
+         oSSink->bOk = (*oSSink->pfWrite)(pcData, ulLength,
+                                          oSSink->pvExtra);
+         break;
+   }
+   if(oSSink->bOk)
+      oSSink->ulLength += ulLength;
+   return oSSink->bOk;
+}
+
+boolean Sink_flush(Sink_T oSSink) {
+   assert(oSSink != NULL);
+
+   if(!oSSink->bOk)
+      return FALSE;
+
+   if(oSSink->eKind == SINK_FILE)
+      oSSink->bOk = fflush(oSSink->psFile) == 0;
+   else if(oSSink->eKind == SINK_FD && oSSink->ulUsed != 0) {
+      struct iovec sVector;
+
+      sVector.iov_base = oSSink->pcBuffer;
+      sVector.iov_len = oSSink->ulUsed;
+      oSSink->ulUsed = 0;
+      oSSink->bOk = Sink_writeAll(oSSink, &sVector, 1);
+   }
+   return oSSink->bOk;
+}
+
+size_t Sink_getLength(Sink_T oSSink) {
+   assert(oSSink != NULL);
+
+   return oSSink->ulLength;
+}
+
+char *Sink_takeString(Sink_T oSSink) {
+   char *pcString;
+
+   assert(oSSink != NULL);
+   assert(oSSink->eKind == SINK_BUFFER);
+
+   if(!oSSink->bOk)
+      return NULL;
+
+   /* a sink nothing was written to has no buffer yet */
+   if(oSSink->pcBuffer == NULL && !Sink_writeBuffer(oSSink, "", 0))
+      return NULL;
+   pcString = oSSink->pcBuffer;
+   pcString[oSSink->ulUsed] = '\0';
+   oSSink->pcBuffer = NULL;
+   oSSink->ulUsed = 0;
+   oSSink->ulPhys = 0;
+   oSSink->ulLength = 0;
+   return pcString;
+}
+
+void Sink_free(Sink_T oSSink) {
+   if(oSSink == NULL)
+      return;
+
+   (void) Sink_flush(oSSink);
+   free(oSSink->pcBuffer);
+   free(oSSink);
+}
@@ -0,0 +1,74 @@
+/*--------------------------------------------------------------------*/
+/* sink.h                                                             */
+/* Author: Zara Hommez                                                */
+/*--------------------------------------------------------------------*/
+
+#ifndef SINK_INCLUDED
+#define SINK_INCLUDED
+
+/*
+  A Sink_T is somewhere bytes can be written to in order: a buffer
+  that grows to hold them, a stdio stream, a file descriptor, or a
+  function of the client's. A sink that fails a write stays failed
+  and ignores later writes, so a writer can go on writing and check
+  once, with Sink_flush, at the end.
+*/
+
+#include <stddef.h>
+#include <stdio.h>
+#include "a4def.h"
+
+typedef struct sink *Sink_T;
+
+/* Returns a new Sink_T that collects what is written to it in a
+   buffer, for Sink_takeString, or NULL if memory could not be
+   allocated. */
+Sink_T Sink_newBuffer(void);
+
+/* Returns a new Sink_T that writes to psFile, which remains the
+   client's, or NULL if memory could not be allocated. */
+Sink_T Sink_newFile(FILE *psFile);
+
+/*
+  Returns a new Sink_T that writes to file descriptor iFd, which
+  remains the client's, or NULL if memory could not be allocated.
+  Small writes are gathered and passed on together; a write that does
+  not fit with what is gathered goes out alongside it in one writev.
+*/
+Sink_T Sink_newFd(int iFd);
+
+/*
+  Returns a new Sink_T that passes each write on as
+  (*pfWrite)(pcData, ulLength, pvExtra), or NULL if memory could not
+  be allocated. pfWrite returns TRUE if it took the bytes, or FALSE to
+  fail the sink.
+*/
+Sink_T Sink_newCallback(boolean (*pfWrite)(const char *pcData,
+                                           size_t ulLength,
+                                           void *pvExtra),
+                        void *pvExtra);
+
+/* Writes the ulLength bytes at pcData to oSSink. Returns TRUE, or
+   FALSE if oSSink has failed this or an earlier write. */
+boolean Sink_write(Sink_T oSSink, const char *pcData, size_t ulLength);
+
+/* Passes on any bytes oSSink has gathered but not yet written. Returns
+   TRUE, or FALSE if oSSink has failed a write. */
+boolean Sink_flush(Sink_T oSSink);
+
+/* Returns the number of bytes written to oSSink, whether or not they
+   have been passed on yet. */
+size_t Sink_getLength(Sink_T oSSink);
+
+/*
+  Returns what has been written to oSSink, a buffer sink, as a
+  '\0'-terminated string then owned by the client, and empties
+  oSSink. Returns NULL if oSSink has failed a write or memory could
+  not be allocated.
+*/
+char *Sink_takeString(Sink_T oSSink);
+
+/* Flushes oSSink, ignoring any failure, and frees it. */
+void Sink_free(Sink_T oSSink);
+
+#endif
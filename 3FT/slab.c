@@ -0,0 +1,376 @@
+/*--------------------------------------------------------------------*/
+/* slab.c                                                             */
+/* Author: Zara Hommez                                                */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "slab.h"
+
+/* The most Slab_Ts that may exist at once: each has a free list in
+   every thread, and those lists are a fixed array */
+enum { MAX_SLABS = 8 };
+
+/* The bytes of objects each page holds, at least one object's worth */
+enum { PAGE_BYTES = 64 * 1024 };
+
+/* The number of objects a thread moves to or from the shared free list
+   at once; it gives back a batch once it holds two */
+enum { BATCH = 32 };
+
+/* The types whose alignment an object must have */
+union align {
+   void *pv;
+   unsigned long long ull;
+   double d;
+};
+
+/* A free object, linked through its first bytes */
+struct freeObject {
+   struct freeObject *psNext;
+};
+
+/* A page: this header, padded to a multiple of sizeof(union align),
+   then the objects */
+struct page {
+   struct page *psNext;
+};
+
+/* The offset of a page's first object */
+enum { PAGE_HEADER = (sizeof(struct page) + sizeof(union align) - 1) /
+       sizeof(union align) * sizeof(union align) };
+
+struct slab {
+   /* the size of each object */
+   size_t ulObjectSize;
+   /* the number of objects in each page */
+   size_t ulPerPage;
+   /* this slab's place in apsSlabs and in each thread's asCaches */
+   size_t ulIndex;
+   /* an identifier no other Slab_T has had, so that a thread can tell
+      its free list for an earlier slab in the same place from this
+      one's */
+   unsigned long ulId;
+   /* guards psFree, psPages and ulPages */
+   pthread_mutex_t sLock;
+   /* the free objects no thread is holding */
+   struct freeObject *psFree;
+   /* the pages, most recently allocated first */
+   struct page *psPages;
+   /* the number of pages */
+   size_t ulPages;
+   /* the number of live objects, and the most there have been; both
+      are updated atomically, as threads allocate without the lock.
+      The atomics are GCC's __atomic builtins, the one extension this
+      module keeps: a mutex taken for every object would cost more
+      than handing the object out. */
+   size_t ulLive;
+   size_t ulPeak;
+};
+
+/* One thread's free list for the Slab_T in the same place */
+struct threadCache {
+   /* the ulId of the Slab_T the list is for, or 0 if none */
+   unsigned long ulId;
+   /* the free objects */
+   struct freeObject *psFree;
+   /* the number of objects in psFree */
+   size_t ulCount;
+};
+
+/* The key under which each thread keeps its free lists, an array of
+   MAX_SLABS of them, one per place in apsSlabs, allocated on the
+   thread's first use of a Slab_T; sCacheKeyOnce makes it, and
+   bCacheKeyMade tells whether that worked */
+static pthread_key_t sCacheKey;
+static pthread_once_t sCacheKeyOnce = PTHREAD_ONCE_INIT;
+static int bCacheKeyMade;
+
+/* Guards apsSlabs and ulNextId */
+static pthread_mutex_t sRegistryLock = PTHREAD_MUTEX_INITIALIZER;
+/* The Slab_Ts in existence, each at its ulIndex, or NULL */
+static Slab_T apsSlabs[MAX_SLABS];
+/* The ulId the next Slab_T gets; 0 is never given out */
+static unsigned long ulNextId = 1;
+
+/*--------------------------------------------------------------------*/
+
+/* Gives the free lists asCaches of a thread that is exiting back to
+   the Slab_Ts they are for that still exist, and frees them. */
+static void Slab_freeCaches(void *asCaches) {
+   struct threadCache *psCache = asCaches;
+   size_t ulIndex;
+
+   pthread_mutex_lock(&sRegistryLock);
+   for(ulIndex = 0; ulIndex < MAX_SLABS; ulIndex++, psCache++) {
+      Slab_T oSSlab = apsSlabs[ulIndex];
+      struct freeObject *psLast = psCache->psFree;
+
+      if(psLast == NULL || oSSlab == NULL ||
+         oSSlab->ulId != psCache->ulId)
+         continue;
+      while(psLast->psNext != NULL)
+         psLast = psLast->psNext;
+      pthread_mutex_lock(&oSSlab->sLock);
+      psLast->psNext = oSSlab->psFree;
+      oSSlab->psFree = psCache->psFree;
+      pthread_mutex_unlock(&oSSlab->sLock);
+   }
+   pthread_mutex_unlock(&sRegistryLock);
+   free(asCaches);
+}
+
+/* Makes sCacheKey, once for the process. */
+static void Slab_makeCacheKey(void) {
+   bCacheKeyMade = pthread_key_create(&sCacheKey, Slab_freeCaches) == 0;
+}
+
+/* Returns this thread's free lists, allocating them if bCreate is 1
+   (TRUE) and it has none yet, or NULL if it has none. */
+static struct threadCache *Slab_getCaches(int bCreate) {
+   struct threadCache *asCaches;
+
+   pthread_once(&sCacheKeyOnce, Slab_makeCacheKey);
+   if(!bCacheKeyMade)
+      return NULL;
+   asCaches = pthread_getspecific(sCacheKey);
+   if(asCaches == NULL && bCreate) {
+      asCaches = calloc(MAX_SLABS, sizeof(struct threadCache));
+      if(asCaches != NULL &&
+         pthread_setspecific(sCacheKey, asCaches) != 0) {
+         free(asCaches);
+         asCaches = NULL;
+      }
+   }
+   return asCaches;
+}
+
+/* Returns this thread's free list for oSSlab, emptied first if it was
+   for an earlier Slab_T, whose objects went with its pages; or NULL if
+   the thread's lists could not be allocated. */
+static struct threadCache *Slab_cacheOf(Slab_T oSSlab) {
+   struct threadCache *asCaches, *psCache;
+
+   assert(oSSlab != NULL);
+
+   asCaches = Slab_getCaches(1);
+   if(asCaches == NULL)
+      return NULL;
+   psCache = &asCaches[oSSlab->ulIndex];
+   if(psCache->ulId != oSSlab->ulId) {
+      psCache->ulId = oSSlab->ulId;
+      psCache->psFree = NULL;
+      psCache->ulCount = 0;
+   }
+   return psCache;
+}
+
+/* Moves a batch of objects from oSSlab's shared free list, which gets
+   a new page first if it is empty, to psCache. Returns 1 (TRUE), or 0
+   (FALSE) if memory could not be allocated. */
+static int Slab_refill(Slab_T oSSlab, struct threadCache *psCache) {
+   size_t i;
+
+   assert(oSSlab != NULL);
+   assert(psCache != NULL);
+
+   pthread_mutex_lock(&oSSlab->sLock);
+   if(oSSlab->psFree == NULL) {
+      struct page *psPage;
+      char *pcObject;
+
+      psPage = malloc(PAGE_HEADER +
+                      oSSlab->ulPerPage * oSSlab->ulObjectSize);
+      if(psPage == NULL) {
+         pthread_mutex_unlock(&oSSlab->sLock);
+         return 0;
+      }
+      psPage->psNext = oSSlab->psPages;
+      oSSlab->psPages = psPage;
+      oSSlab->ulPages++;
+
+      /* thread the objects in address order */
+      pcObject = (char *) psPage + PAGE_HEADER +
+         oSSlab->ulPerPage * oSSlab->ulObjectSize;
+      for(i = 0; i < oSSlab->ulPerPage; i++) {
+         struct freeObject *psObject;
+
+         pcObject -= oSSlab->ulObjectSize;
+         psObject = (struct freeObject *) (void *) pcObject;
+         psObject->psNext = oSSlab->psFree;
+         oSSlab->psFree = psObject;
+      }
+   }
+   for(i = 0; i < BATCH && oSSlab->psFree != NULL; i++) {
+      struct freeObject *psObject = oSSlab->psFree;
+
+      oSSlab->psFree = psObject->psNext;
+      psObject->psNext = psCache->psFree;
+      psCache->psFree = psObject;
+      psCache->ulCount++;
+   }
+   pthread_mutex_unlock(&oSSlab->sLock);
+   return 1;
+}
+
+/* Moves a batch of objects from psCache back to oSSlab's shared free
+   list. */
+static void Slab_flush(Slab_T oSSlab, struct threadCache *psCache) {
+   struct freeObject *psFirst, *psLast;
+   size_t i;
+
+   assert(oSSlab != NULL);
+   assert(psCache != NULL);
+   assert(psCache->ulCount >= BATCH);
+
+   /* unlink the batch before taking the lock */
+   psFirst = psLast = psCache->psFree;
+   for(i = 1; i < BATCH; i++)
+      psLast = psLast->psNext;
+   psCache->psFree = psLast->psNext;
+   psCache->ulCount -= BATCH;
+
+   pthread_mutex_lock(&oSSlab->sLock);
+   psLast->psNext = oSSlab->psFree;
+   oSSlab->psFree = psFirst;
+   pthread_mutex_unlock(&oSSlab->sLock);
+}
+
+/*--------------------------------------------------------------------*/
+
+Slab_T Slab_new(size_t ulObjectSize) {
+   Slab_T oSSlab;
+   size_t ulIndex;
+
+   oSSlab = malloc(sizeof(struct slab));
+   if(oSSlab == NULL)
+      return NULL;
+
+   pthread_mutex_lock(&sRegistryLock);
+   for(ulIndex = 0; ulIndex < MAX_SLABS; ulIndex++)
+      if(apsSlabs[ulIndex] == NULL)
+         break;
+   if(ulIndex == MAX_SLABS) {
+      pthread_mutex_unlock(&sRegistryLock);
+      free(oSSlab);
+      return NULL;
+   }
+   apsSlabs[ulIndex] = oSSlab;
+   oSSlab->ulIndex = ulIndex;
+   oSSlab->ulId = ulNextId++;
+   pthread_mutex_unlock(&sRegistryLock);
+
+   if(ulObjectSize < sizeof(struct freeObject))
+      ulObjectSize = sizeof(struct freeObject);
+   oSSlab->ulObjectSize = (ulObjectSize + sizeof(union align) - 1) /
+      sizeof(union align) * sizeof(union align);
+   oSSlab->ulPerPage = PAGE_BYTES / oSSlab->ulObjectSize;
+   if(oSSlab->ulPerPage == 0)
+      oSSlab->ulPerPage = 1;
+   pthread_mutex_init(&oSSlab->sLock, NULL);
+   oSSlab->psFree = NULL;
+   oSSlab->psPages = NULL;
+   oSSlab->ulPages = 0;
+   oSSlab->ulLive = 0;
+   oSSlab->ulPeak = 0;
+   return oSSlab;
+}
+
+void Slab_free(Slab_T oSSlab) {
+   struct threadCache *asCaches;
+   struct page *psPage;
+
+   if(oSSlab == NULL)
+      return;
+
+   pthread_mutex_lock(&sRegistryLock);
+   apsSlabs[oSSlab->ulIndex] = NULL;
+   pthread_mutex_unlock(&sRegistryLock);
+
+   /* other threads' lists for this slab are dropped when they next
+      meet the Slab_T that takes its place */
+   asCaches = Slab_getCaches(0);
+   if(asCaches != NULL)
+      asCaches[oSSlab->ulIndex].ulId = 0;
+   while((psPage = oSSlab->psPages) != NULL) {
+      oSSlab->psPages = psPage->psNext;
+      free(psPage);
+   }
+   pthread_mutex_destroy(&oSSlab->sLock);
+   free(oSSlab);
+}
+
+void *Slab_alloc(Slab_T oSSlab) {
+   struct threadCache *psCache;
+   struct freeObject *psObject;
+   size_t ulLive, ulPeak;
+
+   assert(oSSlab != NULL);
+
+   psCache = Slab_cacheOf(oSSlab);
+   if(psCache == NULL ||
+      (psCache->psFree == NULL && !Slab_refill(oSSlab, psCache)))
+      return NULL;
+   psObject = psCache->psFree;
+   psCache->psFree = psObject->psNext;
+   psCache->ulCount--;
+
+   ulLive = __atomic_add_fetch(&oSSlab->ulLive, 1, __ATOMIC_RELAXED);
+   ulPeak = __atomic_load_n(&oSSlab->ulPeak, __ATOMIC_RELAXED);
+   while(ulLive > ulPeak &&
+         !__atomic_compare_exchange_n(&oSSlab->ulPeak, &ulPeak, ulLive,
+                                      0, __ATOMIC_RELAXED,
+                                      __ATOMIC_RELAXED))
+      ;
+   return psObject;
+}
+
+void Slab_release(Slab_T oSSlab, void *pvObject) {
+   struct threadCache *psCache;
+   struct freeObject *psObject = pvObject;
+
+   assert(oSSlab != NULL);
+   assert(pvObject != NULL);
+
+   psCache = Slab_cacheOf(oSSlab);
+   if(psCache == NULL) {
+      /* with no list of its own, the thread gives it straight back */
+      pthread_mutex_lock(&oSSlab->sLock);
+      psObject->psNext = oSSlab->psFree;
+      oSSlab->psFree = psObject;
+      pthread_mutex_unlock(&oSSlab->sLock);
+   }
+   else {
+      psObject->psNext = psCache->psFree;
+      psCache->psFree = psObject;
+      psCache->ulCount++;
+      if(psCache->ulCount >= 2 * BATCH)
+         Slab_flush(oSSlab, psCache);
+   }
+
+   (void) __atomic_sub_fetch(&oSSlab->ulLive, 1, __ATOMIC_RELAXED);
+}
+
+void Slab_getStats(Slab_T oSSlab, struct Slab_Stats *psStats) {
+   assert(psStats != NULL);
+
+   if(oSSlab == NULL) {
+      psStats->ulObjectSize = 0;
+      psStats->ulLive = 0;
+      psStats->ulPeak = 0;
+      psStats->ulPages = 0;
+      psStats->ulBytes = 0;
+      return;
+   }
+
+   psStats->ulObjectSize = oSSlab->ulObjectSize;
+   psStats->ulLive = __atomic_load_n(&oSSlab->ulLive, __ATOMIC_RELAXED);
+   psStats->ulPeak = __atomic_load_n(&oSSlab->ulPeak, __ATOMIC_RELAXED);
+   pthread_mutex_lock(&oSSlab->sLock);
+   psStats->ulPages = oSSlab->ulPages;
+   pthread_mutex_unlock(&oSSlab->sLock);
+   psStats->ulBytes = sizeof(struct slab) + psStats->ulPages *
+      (PAGE_HEADER + oSSlab->ulPerPage * oSSlab->ulObjectSize);
+}
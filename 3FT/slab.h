@@ -0,0 +1,57 @@
+/*--------------------------------------------------------------------*/
+/* slab.h                                                             */
+/* Author: Zara Hommez                                                */
+/*--------------------------------------------------------------------*/
+
+#ifndef SLAB_INCLUDED
+#define SLAB_INCLUDED
+
+/*
+  A Slab_T hands out objects of one fixed size, carved from large
+  pages that it keeps until it is freed. Each thread keeps a short
+  free list of its own for each Slab_T, so allocating and releasing
+  an object usually takes no lock and no call to malloc; a thread
+  moves objects between its list and the shared one in batches, and
+  gives back what its lists hold when it exits.
+*/
+
+#include <stddef.h>
+
+typedef struct slab *Slab_T;
+
+/* Counters describing a Slab_T's memory use */
+struct Slab_Stats {
+   /* the size of each object, after rounding up for alignment */
+   size_t ulObjectSize;
+   /* the number of objects allocated and not yet released */
+   size_t ulLive;
+   /* the most objects that have been live at once */
+   size_t ulPeak;
+   /* the number of pages allocated */
+   size_t ulPages;
+   /* the bytes the pages and the handle take up */
+   size_t ulBytes;
+};
+
+/*
+  Returns a new Slab_T for objects of ulObjectSize bytes, or NULL if
+  memory could not be allocated or too many Slab_Ts exist already.
+*/
+Slab_T Slab_new(size_t ulObjectSize);
+
+/* Frees oSSlab and every page it allocated, along with any objects
+   still live in them. */
+void Slab_free(Slab_T oSSlab);
+
+/* Returns a new object from oSSlab, or NULL if memory could not be
+   allocated. Its contents are undefined. */
+void *Slab_alloc(Slab_T oSSlab);
+
+/* Returns pvObject, which Slab_alloc gave out for oSSlab, to it. */
+void Slab_release(Slab_T oSSlab, void *pvObject);
+
+/* Fills *psStats with oSSlab's counters, or with zeros if oSSlab is
+   NULL. */
+void Slab_getStats(Slab_T oSSlab, struct Slab_Stats *psStats);
+
+#endif